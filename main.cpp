@@ -1,483 +1,446 @@
+#include "reflekt.hpp"
+#include "reflekt_async.hpp"
+#include "reflekt_buffered.hpp"
+#include "reflekt_diff.hpp"
+#include "reflekt_history.hpp"
+#include "reflekt_msgpack.hpp"
+#include "reflekt_patch.hpp"
+#include "reflekt_paged.hpp"
+#include "reflekt_shm.hpp"
+
+#include <climits>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
-#include <optional>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <utility>
-#include <variant>
 #include <vector>
 
-using PropertyValue = std::variant<int, double, std::string, bool>;
-
-class DynamicType;
-class DynamicObject;
-
-struct PropertyDescriptor
+void demonstrate_usage()
 {
-    std::string name;
-    std::string type_name;
-    PropertyValue default_value;
-    bool is_inherited = false;
-
-    PropertyDescriptor(std::string n, std::string t, PropertyValue def = {}) :
-        name(std::move(n)), type_name(std::move(t)), default_value(std::move(def))
-    {
-    }
-};
+    // programmatically register types
+    auto base_type = std::make_unique<TypeDescriptor>("Entity");
+    base_type->add_property("id", "int", 0);
+    base_type->add_property("name", "string", std::string(""));
+    TypeRegistry::instance().register_type(std::move(base_type));
 
-class TypeDescriptor
-{
-public:
-    std::string type_name;
-    std::string base_type_name;
-    std::vector<PropertyDescriptor> properties;
+    auto derived_type = std::make_unique<TypeDescriptor>("Player");
+    derived_type->set_base_type("Entity");
+    derived_type->add_property("level", "int", 1);
+    derived_type->add_property("health", "double", 100.0);
+    TypeRegistry::instance().register_type(std::move(derived_type));
 
-    explicit TypeDescriptor(std::string name) : type_name(std::move(name)) {}
+    // we can also register types via DSL
+    std::string property_content = R"(
+Weapon: Entity
+damage: int = 50
+range: double = 10.5
+magical: bool = false
+owner: ref<Player>
+)";
 
-    void add_property(const std::string &name, const std::string &type, PropertyValue default_val = {})
+    if (auto parsed_type = PropertyFileParser::parse_simple_format(property_content))
     {
-        properties.emplace_back(name, type, std::move(default_val));
+        TypeRegistry::instance().register_type(std::move(parsed_type));
     }
 
-    void set_base_type(const std::string &base) { base_type_name = base; }
-};
-
-class TypeRegistry
-{
-private:
-    std::unordered_map<std::string, std::unique_ptr<TypeDescriptor>> types_;
-    std::unordered_map<std::string, std::vector<std::string>> inheritance_graph_;
-
-public:
-    static TypeRegistry &instance()
+    // create objects dynamically
+    auto player = ObjectFactory::create("Player");
+    if (player)
     {
-        static TypeRegistry registry;
-        return registry;
+        player->set_property("name", std::string("Hero"));
+        player->set_property("level", 30);
+        player->set_property("health", 65.0);
     }
 
-    void register_type(std::unique_ptr<TypeDescriptor> type)
+    auto weapon = ObjectFactory::create("Weapon");
+    if (weapon)
     {
-        const auto &name = type->type_name;
-        const auto &base = type->base_type_name;
-
-        if (!base.empty())
-        {
-            inheritance_graph_[name].push_back(base);
-        }
-
-        types_[name] = std::move(type);
+        weapon->set_property("name", std::string("Excalibur"));
+        weapon->set_property("damage", 75);
     }
 
-    [[nodiscard]] const TypeDescriptor *get_type(const std::string &name) const
-    {
-        const auto it = types_.find(name);
-        return it != types_.end() ? it->second.get() : nullptr;
-    }
+    // print type info
+    std::cout << "=== Type Information ===\n\n";
+    print_type_info("Entity");
+    print_type_info("Player");
+    print_type_info("Weapon");
 
-    [[nodiscard]] std::vector<PropertyDescriptor> get_all_properties(const std::string &type_name) const
+    // print object instance info
+    std::cout << "=== Object Information ===\n\n";
+    if (player)
     {
-        std::vector<PropertyDescriptor> all_props;
-        collect_properties_recursive(type_name, all_props);
-        return all_props;
+        print_object_info(*player);
     }
-
-private:
-    void collect_properties_recursive(const std::string &type_name, std::vector<PropertyDescriptor> &props) const
+    if (weapon)
     {
-        const auto type = get_type(type_name);
-        if (!type) return;
+        print_object_info(*weapon);
 
-        if (!type->base_type_name.empty())
-        {
-            collect_properties_recursive(type->base_type_name, props);
-        }
+        // variants share the configured prototype and only store overrides
+        std::shared_ptr<const DynamicObject> excalibur = std::move(weapon);
+        auto replica = ObjectFactory::create_from_prototype(excalibur);
+        replica->set_property("name", std::string("Excalibur Replica"));
+        print_object_info(*replica);
+    }
 
-        for (const auto &prop : type->properties)
+    // example using generic iterators
+    std::cout << "=== Generic Iterators ===\n\n";
+    std::cout << "Player type properties:\n";
+    iterate_type_properties(
+        "Player",
+        [](const std::string &name, const std::string &type, const PropertyValue &default_val, bool inherited)
         {
-            props.push_back(prop);
-        }
+            std::cout << "  " << name << " (" << type << ") = " << property_value_to_string(default_val);
+            if (inherited) std::cout << " [inherited]";
+            std::cout << "\n";
+        });
+
+    std::cout << "\nPlayer object properties:\n";
+    if (player)
+    {
+        iterate_object_properties(*player, [](const std::string &name, const PropertyValue &value)
+                                  { std::cout << "  " << name << " = " << property_value_to_string(value) << "\n"; });
     }
-};
+}
 
-class DynamicObject
+void demonstrate_store()
 {
-private:
-    std::string type_name_;
-    std::unordered_map<std::string, PropertyValue> properties_;
-
-public:
-    explicit DynamicObject(std::string type_name) : type_name_(std::move(type_name))
+    // bulk objects live in a columnar store instead of one map per object
+    ObjectStore players("Player");
+    const int levels[] = {10, 20, 10, 30, 20, 10};
+    const double healths[] = {80.0, 55.0, 100.0, 35.0, 75.0, 60.0};
+    for (size_t i = 0; i < 6; ++i)
     {
-        const auto all_props = TypeRegistry::instance().get_all_properties(type_name_);
-        for (const auto &prop : all_props)
-        {
-            properties_[prop.name] = prop.default_value;
-        }
+        // literal keys are hashed at compile time
+        const auto handle = players.create();
+        players.set_property(handle, "id"_prop, static_cast<int>(i));
+        players.set_property(handle, "level"_prop, levels[i]);
+        players.set_property(handle, "health"_prop, healths[i]);
     }
 
-    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
-
-    template <typename T>
-    void set_property(const std::string &name, const T &value)
+    std::cout << "\n=== Store Analytics ===\n\n";
+    std::cout << "count: " << StoreAnalytics::count(players) << "\n";
+    std::cout << "mean health: " << StoreAnalytics::mean(players, "health").value_or(0.0) << "\n";
+    std::cout << "max level: " << StoreAnalytics::max(players, "level").value_or(0.0) << "\n";
+    std::cout << "mean health by level:\n";
+    for (const auto &[level, aggregate] : StoreAnalytics::group_by(players, "level", "health"))
     {
-        properties_[name] = value;
+        std::cout << "  " << property_value_to_string(level) << ": " << aggregate.mean() << " (" << aggregate.count
+                  << " players)\n";
     }
 
-    template <typename T>
-    [[nodiscard]] std::optional<T> get_property(const std::string &name) const
+    // leaderboard order; handles survive the physical reorder
+    StoreSorter::reorder_by(players, "level", SortOrder::Descending);
+    std::cout << "players by level (descending):\n";
+    for (size_t row = 0; row < players.size(); ++row)
     {
-        if (const auto it = properties_.find(name); it != properties_.end())
-        {
-            if (std::holds_alternative<T>(it->second))
-            {
-                return std::get<T>(it->second);
-            }
-        }
-
-        return std::nullopt;
+        const auto handle = players.handle_at(row);
+        std::cout << "  id " << players.get_property<int>(handle, "id").value_or(-1) << ": level "
+                  << players.get_property<int>(handle, "level").value_or(0) << "\n";
     }
 
-    [[nodiscard]] PropertyValue get_property_variant(const std::string &name) const
+    // weapons reference their owners by handle; the join resolves each
+    // reference through the player store's handle table
+    ObjectStore weapons("Weapon");
+    for (size_t row = 0; row < 3; ++row)
     {
-        const auto it = properties_.find(name);
-        return it != properties_.end() ? it->second : PropertyValue();
+        const auto weapon = weapons.create();
+        weapons.set_property(weapon, "id", static_cast<int>(100 + row));
+        weapons.set_reference(weapon, "owner", players, players.handle_at(row));
     }
+    weapons.create();
 
-    [[nodiscard]] std::vector<std::string> get_property_names() const
+    std::cout << "weapons joined to owners:\n";
+    for (const auto &[weapon, owner] : StoreJoin::join(weapons, "owner", players))
     {
-        std::vector<std::string> names;
-        for (const auto &[name, value] : properties_)
-        {
-            names.push_back(name);
-        }
-
-        return names;
+        std::cout << "  weapon " << weapons.get_property<int>(weapon, "id").value_or(-1) << " -> player "
+                  << players.get_property<int>(owner, "id").value_or(-1) << "\n";
     }
 
-    [[nodiscard]] bool is_type(const std::string &type_name) const
+    // CSV round-trip: empty names, quoting and the null owner must survive
+    weapons.set_property(weapons.handle_at(1), "name", std::string("Long, \"Sharp\" Sword"));
+    weapons.set_property(weapons.handle_at(2), "name", std::string("Bow"));
+    std::stringstream csv;
+    ObjectStore imported("Weapon");
+    bool same = StoreCsv::export_csv(weapons, csv) && StoreCsv::import_csv(imported, csv).ok &&
+                imported.size() == weapons.size();
+    for (size_t row = 0; same && row < weapons.size(); ++row)
     {
-        if (type_name_ == type_name) return true;
-
-        const auto all_props = TypeRegistry::instance().get_all_properties(type_name_);
-        const auto target_props = TypeRegistry::instance().get_all_properties(type_name);
-
-        for (const auto &target_prop : target_props)
+        for (size_t slot = 0; same && slot < weapons.slot_count(); ++slot)
         {
-            bool found = false;
-            for (const auto &our_prop : all_props)
-            {
-                if (our_prop.name == target_prop.name && our_prop.type_name == target_prop.type_name)
-                {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) return false;
+            same = imported.get_value(row, slot) == weapons.get_value(row, slot);
         }
-
-        return !target_props.empty();
     }
-};
+    std::cout << "csv round-trip: " << (same ? "ok" : "mismatch") << "\n";
+}
 
-class ObjectFactory
+void demonstrate_shared_memory()
 {
-public:
-    static std::unique_ptr<DynamicObject> create(const std::string &type_name)
-    {
-        if (const auto type_desc = TypeRegistry::instance().get_type(type_name); !type_desc)
-        {
-            return nullptr;
-        }
+    std::cout << "\n=== Shared Memory ===\n\n";
 
-        return std::make_unique<DynamicObject>(type_name);
+    ObjectStore players("Player");
+    for (int i = 0; i < 8; ++i)
+    {
+        const auto handle = players.create();
+        players.set_property(handle, "level", 10 * i);
+        players.set_property(handle, "name", "player " + std::to_string(i));
     }
-};
 
-class PropertyFileParser
-{
-public:
-    static std::unique_ptr<TypeDescriptor> parse_simple_format(const std::string &content)
+    // a sidecar would open the segment from another process; the reader
+    // sees the columns in place, not a copy
+    const auto summarize = [](const SharedStoreView &view)
     {
-        auto lines = split_lines(content);
-        if (lines.empty()) return nullptr;
-
-        auto type_line = split(lines[0], ':');
-        if (type_line.empty()) return nullptr;
-
-        auto type_desc = std::make_unique<TypeDescriptor>(trim(type_line[0]));
-
-        if (type_line.size() > 1)
+        const auto level = view.find_slot("level");
+        const int *levels = level ? view.column<int>(*level) : nullptr;
+        int level_sum = 0;
+        for (size_t row = 0; levels && row < view.size(); ++row)
         {
-            type_desc->set_base_type(type_line[1]);
+            level_sum += levels[row];
         }
 
-        for (size_t i = 1; i < lines.size(); ++i)
-        {
-            if (auto prop_parts = split(lines[i], ':'); prop_parts.size() >= 2)
-            {
-                std::string prop_name = trim(prop_parts[0]);
-
-                auto type_default = split(prop_parts[1], '=');
-                std::string prop_type = trim(type_default[0]);
-
-                PropertyValue default_val;
-                if (type_default.size() > 1)
-                {
-                    std::string default_str = trim(type_default[1]);
-                    default_val = parse_default_value(prop_type, default_str);
-                }
-
-                type_desc->add_property(prop_name, prop_type, default_val);
-            }
-        }
+        const auto name = view.find_slot("name");
+        return std::make_pair(level_sum, std::string(name ? view.string_at(*name, 7) : std::string_view()));
+    };
 
-        return type_desc;
-    }
+    const auto publisher = SharedStorePublisher::create("/reflekt-demo-" + std::to_string(getpid()), "Player", 64);
+    const auto reader =
+        publisher && publisher->publish(players) ? SharedStoreReader::open(publisher->get_name()) : nullptr;
+    const auto snapshot = reader ? reader->read(summarize) : std::nullopt;
 
-private:
-    static std::vector<std::string> split_lines(const std::string &str)
-    {
-        std::vector<std::string> lines;
-        std::istringstream iss(str);
-        std::string line;
-        while (std::getline(iss, line))
-        {
-            if (!line.empty())
-            {
-                lines.push_back(line);
-            }
-        }
-        return lines;
-    }
+    std::cout << "readers see " << (snapshot ? snapshot->first : -1) << " total levels\n";
+    const bool same = snapshot && snapshot->first == 280 && snapshot->second == "player 7";
+    std::cout << "shared memory snapshot: " << (same ? "ok" : "mismatch") << "\n";
+}
+
+void demonstrate_paged_store()
+{
+    std::cout << "\n=== Paged Store ===\n\n";
 
-    static std::vector<std::string> split(const std::string &str, const char delimiter)
+    // a budget of a few chunks forces most of them out to the spill file
+    const auto spill_path = std::filesystem::temp_directory_path() / ("reflekt-demo-" + std::to_string(getpid()));
+    const auto players = PagedObjectStore::create("Player", spill_path.string(), 16 * 1024, 64);
+    std::vector<ObjectHandle> handles;
+    for (int i = 0; players && i < 1000; ++i)
     {
-        std::vector<std::string> tokens;
-        std::istringstream iss(str);
-        std::string token;
-        while (std::getline(iss, token, delimiter))
-        {
-            tokens.push_back(token);
-        }
-        return tokens;
+        handles.push_back(players->create());
+        players->set_property(handles.back(), "level", i);
     }
 
-    static std::string trim(const std::string &str)
+    bool same = players && players->size() == handles.size();
+    for (size_t i = 0; same && i < handles.size(); ++i)
     {
-        const size_t start = str.find_first_not_of(" \t\r\n");
-        if (start == std::string::npos) return "";
-        const size_t end = str.find_last_not_of(" \t\r\n");
-        return str.substr(start, end - start + 1);
+        same = players->get_property<int>(handles[i], "level") == static_cast<int>(i);
     }
 
-    static PropertyValue parse_default_value(const std::string &type, const std::string &value)
+    if (players)
     {
-        if (type == "int")
-        {
-            return std::stoi(value);
-        }
-        else if (type == "double")
-        {
-            return std::stod(value);
-        }
-        else if (type == "bool")
-        {
-            return value == "true" || value == "1";
-        }
-        else
-        {
-            return value;
-        }
+        std::cout << players->resident_chunks() << " of " << players->chunk_count() << " chunks resident, "
+                  << players->eviction_count() << " evictions, " << players->fault_count() << " faults\n";
+        same = same && players->eviction_count() > 0 && players->spill_error_count() == 0;
     }
-};
+    std::cout << "paged store round-trip: " << (same ? "ok" : "mismatch") << "\n";
+}
 
-std::string property_value_to_string(const PropertyValue &value)
+void demonstrate_async_loading()
 {
-    return std::visit(
-        [](const auto &v) -> std::string
-        {
-            using T = std::decay_t<decltype(v)>;
-            if constexpr (std::is_same_v<T, std::string>)
-            {
-                return "\"" + v + "\"";
-            }
-            else if constexpr (std::is_same_v<T, bool>)
-            {
-                return v ? "true" : "false";
-            }
-            else
-            {
-                return std::to_string(v);
-            }
-        },
-        value);
+    std::cout << "\n=== Async Schema Loading ===\n\n";
+
+    // Mount's base lives in a later file; registration waits for it
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string pid = std::to_string(getpid());
+    const std::vector<std::string> paths = {
+        (directory / ("reflekt-demo-mounts-" + pid + ".rk")).string(),
+        (directory / ("reflekt-demo-vehicles-" + pid + ".rk")).string(),
+        (directory / ("reflekt-demo-missing-" + pid + ".rk")).string(),
+    };
+    std::ofstream(paths[0]) << "Mount: Vehicle\nspeed: double = 12.5\n";
+    std::ofstream(paths[1]) << "Vehicle: Entity\nwheels: int = 4\n\nCart: Vehicle\ncapacity: int = 8\n";
+
+    const auto result = AsyncSchemaLoader::load(paths);
+    std::cout << "backend: " << (result.backend == IoBackend::IoUring ? "io_uring" : "thread pool") << ", "
+              << result.files_read << " files, " << result.types_registered << " types\n";
+
+    const auto mount = ObjectFactory::create("Mount");
+    const bool same = result.types_registered == 3 && result.failed_files.size() == 1 &&
+                      result.failed_files[0] == paths[2] && mount && mount->get_property<int>("wheels") == 4;
+    std::cout << "async schema load: " << (same ? "ok" : "mismatch") << "\n";
+
+    std::filesystem::remove(paths[0]);
+    std::filesystem::remove(paths[1]);
 }
 
-void print_type_info(const std::string &type_name)
+void demonstrate_msgpack()
 {
-    auto *type_desc = TypeRegistry::instance().get_type(type_name);
-    if (!type_desc)
+    std::cout << "\n=== MessagePack ===\n\n";
+
+    ObjectStore weapons("Weapon");
+    for (int i = 0; i < 3; ++i)
     {
-        std::cout << "Type '" << type_name << "' not found!\n";
-        return;
+        const auto weapon = weapons.create();
+        weapons.set_property(weapon, "name", "blade " + std::to_string(i));
+        weapons.set_property(weapon, "damage", 40 + i);
+        weapons.set_property(weapon, "range", 1.5 * i);
+        weapons.set_property(weapon, "magical", i == 1);
     }
-
-    std::cout << "type_name: " << type_desc->type_name << "\n";
-    std::cout << "base: " << (type_desc->base_type_name.empty() ? "none" : type_desc->base_type_name) << "\n";
-    std::cout << "properties:\n";
-
-    const auto all_props = TypeRegistry::instance().get_all_properties(type_name);
-
-    for (const auto &prop : all_props)
+    weapons.set_property(weapons.handle_at(2), "owner", ObjectHandle{7, 3});
+
+    // every type's keys are encoded once per codec, not once per object
+    const auto codec = MsgPackCodec::for_type("Weapon");
+    std::string bytes;
+    MsgPackWriter writer(bytes);
+    bool same = codec && codec->encode(weapons, writer);
+
+    ObjectStore decoded("Weapon");
+    MsgPackReader reader(bytes);
+    same = same && codec->decode_all(reader, decoded) && reader.at_end() && decoded.size() == weapons.size();
+    for (size_t row = 0; same && row < weapons.size(); ++row)
     {
-        std::cout << "  - " << prop.name << ":\n";
-        std::cout << "    type: " << prop.type_name << "\n";
-        std::cout << "    default_value: " << property_value_to_string(prop.default_value) << "\n";
-        std::cout << "    inherited: " << (prop.is_inherited ? "true" : "false") << "\n";
+        for (size_t slot = 0; same && slot < weapons.slot_count(); ++slot)
+        {
+            same = decoded.get_value(row, slot) == weapons.get_value(row, slot);
+        }
     }
 
-    std::cout << "\n";
+    std::cout << weapons.size() << " weapons in " << bytes.size() << " bytes\n";
+    std::cout << "msgpack round-trip: " << (same ? "ok" : "mismatch") << "\n";
 }
 
-void print_object_info(const DynamicObject &obj)
+void demonstrate_double_buffering()
 {
-    std::cout << "object_type: " << obj.get_type_name() << "\n";
-    std::cout << "properties:\n";
+    std::cout << "\n=== Double-Buffered Reads ===\n\n";
 
-    const auto prop_names = obj.get_property_names();
-    for (const auto &name : prop_names)
+    ObjectStore players("Player");
+    for (int i = 0; i < 3000; ++i)
     {
-        auto value = obj.get_property_variant(name);
-        std::cout << "  - " << name << ":\n";
-        std::cout << "    value: " << property_value_to_string(value) << "\n";
-
-        std::string actual_type = std::visit(
-            [](const auto &v) -> std::string
-            {
-                using T = std::decay_t<decltype(v)>;
-                if constexpr (std::is_same_v<T, int>)
-                    return "int";
-                else if constexpr (std::is_same_v<T, double>)
-                    return "double";
-                else if constexpr (std::is_same_v<T, std::string>)
-                    return "string";
-                else if constexpr (std::is_same_v<T, bool>)
-                    return "bool";
-                else
-                    return "unknown";
-            },
-            value);
-
-        std::cout << "    runtime_type: " << actual_type << "\n";
+        players.set_property(players.create(), "level", i);
     }
 
-    std::cout << "\n";
-}
+    // both buffers start out as full copies
+    DoubleBufferedStore buffered(players);
+    buffered.sync();
+    buffered.sync();
 
-template <typename Func>
-void iterate_type_properties(const std::string &type_name, Func &&callback)
-{
-    const auto all_props = TypeRegistry::instance().get_all_properties(type_name);
-    for (const auto &prop : all_props)
-    {
-        callback(prop.name, prop.type_name, prop.default_value, prop.is_inherited);
-    }
-}
+    // readers keep the last synced copy while the simulation writes
+    const auto hero = players.handle_at(2500);
+    players.set_property(hero, "level", 99);
+    const bool stable = buffered.read().get_property<int>(hero, "level") == 2500;
 
-template <typename Func>
-void iterate_object_properties(const DynamicObject &obj, Func &&callback)
-{
-    const auto prop_names = obj.get_property_names();
-    for (const auto &name : prop_names)
-    {
-        auto value = obj.get_property_variant(name);
-        callback(name, value);
-    }
+    buffered.sync();
+    const bool synced = buffered.read().get_property<int>(hero, "level") == 99;
+    std::cout << "sync copied " << buffered.last_copied_chunks() << " dirty chunk(s) of "
+              << (players.size() + ObjectStore::version_chunk_rows - 1) / ObjectStore::version_chunk_rows << "\n";
+
+    const bool same = stable && synced && buffered.last_copied_chunks() == 1;
+    std::cout << "double-buffered sync: " << (same ? "ok" : "mismatch") << "\n";
 }
 
-void demonstrate_usage()
+void demonstrate_history()
 {
-    // programmatically register types
-    auto base_type = std::make_unique<TypeDescriptor>("Entity");
-    base_type->add_property("id", "int", 0);
-    base_type->add_property("name", "string", std::string(""));
-    TypeRegistry::instance().register_type(std::move(base_type));
-
-    auto derived_type = std::make_unique<TypeDescriptor>("Player");
-    derived_type->set_base_type("Entity");
-    derived_type->add_property("level", "int", 1);
-    derived_type->add_property("health", "double", 100.0);
-    TypeRegistry::instance().register_type(std::move(derived_type));
+    std::cout << "\n=== Rollback History ===\n\n";
 
-    // we can also register types via DSL
-    std::string property_content = R"(
-Weapon: Entity
-damage: int = 50
-range: double = 10.5
-magical: bool = false
+    // only x keeps history; label is left alone by a rewind
+    const std::string projectile_content = R"(
+Projectile
+x: double = 0 @history(8)
+label: string
 )";
-
-    if (auto parsed_type = PropertyFileParser::parse_simple_format(property_content))
+    if (auto parsed_type = PropertyFileParser::parse_simple_format(projectile_content))
     {
         TypeRegistry::instance().register_type(std::move(parsed_type));
     }
 
-    // create objects dynamically
-    auto player = ObjectFactory::create("Player");
-    if (player)
+    ObjectStore projectiles("Projectile");
+    const auto arrow = projectiles.create();
+    StoreHistory history(projectiles);
+    for (int tick = 1; tick <= 6; ++tick)
     {
-        player->set_property("name", std::string("Hero"));
-        player->set_property("level", 30);
-        player->set_property("health", 65.0);
+        projectiles.set_property(arrow, "x", 1.5 * tick);
+        history.record();
     }
+    projectiles.set_property(arrow, "label", std::string("late"));
 
-    auto weapon = ObjectFactory::create("Weapon");
-    if (weapon)
-    {
-        weapon->set_property("name", std::string("Excalibur"));
-        weapon->set_property("damage", 75);
-    }
+    const bool rewound = history.rewind_to(3);
+    std::cout << "x after rewinding to tick 3: " << projectiles.get_property<double>(arrow, "x").value_or(-1.0)
+              << "\n";
 
-    // print type info
-    std::cout << "=== Type Information ===\n\n";
-    print_type_info("Entity");
-    print_type_info("Player");
-    print_type_info("Weapon");
+    const bool same = rewound && history.tracked_slot_count() == 1 &&
+                      projectiles.get_property<double>(arrow, "x") == 4.5 &&
+                      projectiles.get_property<std::string>(arrow, "label") == "late";
+    std::cout << "history rewind: " << (same ? "ok" : "mismatch") << "\n";
+}
 
-    // print object instance info
-    std::cout << "=== Object Information ===\n\n";
-    if (player)
+void demonstrate_diff()
+{
+    std::cout << "\n=== Store Diff ===\n\n";
+
+    ObjectStore players("Player");
+    for (int i = 0; i < 2000; ++i)
     {
-        print_object_info(*player);
+        players.set_property(players.create(), "level", i);
     }
-    if (weapon)
+
+    // a copy shares the handle history, so objects match by handle
+    ObjectStore snapshot = players;
+    players.set_property(players.handle_at(10), "level", 500);
+    players.destroy(players.handle_at(20));
+    players.set_property(players.create(), "name", std::string("newcomer"));
+
+    const auto changes = StoreDiff::diff(snapshot, players);
+    if (changes)
     {
-        print_object_info(*weapon);
+        std::cout << changes->added.size() << " added, " << changes->removed.size() << " removed, "
+                  << changes->changed.size() << " values changed\n";
     }
 
-    // example using generic iterators
-    std::cout << "=== Generic Iterators ===\n\n";
-    std::cout << "Player type properties:\n";
-    iterate_type_properties(
-        "Player",
-        [](const std::string &name, const std::string &type, const PropertyValue &default_val, bool inherited)
-        {
-            std::cout << "  " << name << " (" << type << ") = " << property_value_to_string(default_val);
-            if (inherited) std::cout << " [inherited]";
-            std::cout << "\n";
-        });
+    // replaying the change set brings the snapshot up to date
+    const bool same = changes && changes->added.size() == 1 && changes->removed.size() == 1 &&
+                      StoreDiff::apply(snapshot, *changes) &&
+                      StoreDigest::compute(snapshot) == StoreDigest::compute(players);
+    std::cout << "store diff replay: " << (same ? "ok" : "mismatch") << "\n";
+}
 
-    std::cout << "\nPlayer object properties:\n";
-    if (player)
+void demonstrate_patches()
+{
+    std::cout << "\n=== Patches ===\n\n";
+
+    ObjectStore weapons("Weapon");
+    const char *names[] = {"Club", "Wand", "Cursed Blade"};
+    for (int i = 0; i < 3; ++i)
     {
-        iterate_object_properties(*player, [](const std::string &name, const PropertyValue &value)
-                                  { std::cout << "  " << name << " = " << property_value_to_string(value) << "\n"; });
+        const auto weapon = weapons.create();
+        weapons.set_property(weapon, "name", std::string(names[i]));
+        weapons.set_property(weapon, "magical", i == 1);
     }
+
+    // later priorities see earlier results; int results saturate
+    PatchSet patches;
+    const std::string balance_pass = R"(
+# balance pass
+Weapon where magical == true: damage *= 1.2
+Weapon: damage += 5
+)";
+    const bool balance = patches.load(balance_pass).ok;
+    const bool curse = patches.load(R"(Weapon where name == "Cursed Blade": damage *= 1e12)", 1).ok;
+    const auto result = patches.apply(weapons);
+    std::cout << result.patches << " patches wrote " << result.values_written << " values\n";
+
+    const auto damage = [&](const size_t row) { return weapons.get_property<int>(weapons.handle_at(row), "damage"); };
+    const bool same = balance && curse && damage(0) == 55 && damage(1) == 65 && damage(2) == INT_MAX;
+    std::cout << "patch apply: " << (same ? "ok" : "mismatch") << "\n";
 }
 
 int main()
 {
     demonstrate_usage();
+    demonstrate_store();
+    demonstrate_shared_memory();
+    demonstrate_paged_store();
+    demonstrate_async_loading();
+    demonstrate_msgpack();
+    demonstrate_double_buffering();
+    demonstrate_history();
+    demonstrate_diff();
+    demonstrate_patches();
     return 0;
 }
@@ -0,0 +1,4106 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// handles stay valid while rows move around inside a store; the generation
+// catches use-after-destroy when a handle index gets recycled
+struct ObjectHandle
+{
+    static constexpr uint32_t invalid_index = UINT32_MAX;
+
+    uint32_t index = invalid_index;
+    uint32_t generation = 0;
+
+    [[nodiscard]] bool is_valid() const { return index != invalid_index; }
+
+    bool operator==(const ObjectHandle &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const ObjectHandle &other) const { return !(*this == other); }
+    bool operator<(const ObjectHandle &other) const
+    {
+        return index != other.index ? index < other.index : generation < other.generation;
+    }
+};
+
+namespace std
+{
+template <>
+struct hash<ObjectHandle>
+{
+    size_t operator()(const ObjectHandle &handle) const noexcept
+    {
+        return hash<uint64_t>()(static_cast<uint64_t>(handle.index) << 32 | handle.generation);
+    }
+};
+} // namespace std
+
+// ObjectHandle values back "ref<Type>" properties
+using PropertyValue = std::variant<int, double, std::string, bool, ObjectHandle>;
+
+class DynamicType;
+class DynamicObject;
+
+// FNV-1a over a type or property name; constexpr so literal keys are folded
+// at compile time and lookups by key never hash a string at runtime
+constexpr uint64_t hash_name(const std::string_view name)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// precomputed lookup keys: "Player"_type, "health"_prop. Two names with the
+// same key are rejected when the type is registered, so a key is enough to
+// identify a type or a property within a type.
+struct TypeKey
+{
+    uint64_t hash = 0;
+
+    constexpr explicit TypeKey(const std::string_view name) : hash(hash_name(name)) {}
+};
+
+struct PropertyKey
+{
+    uint64_t hash = 0;
+
+    constexpr explicit PropertyKey(const std::string_view name) : hash(hash_name(name)) {}
+};
+
+constexpr TypeKey operator""_type(const char *name, const size_t size) { return TypeKey(std::string_view(name, size)); }
+
+constexpr PropertyKey operator""_prop(const char *name, const size_t size)
+{
+    return PropertyKey(std::string_view(name, size));
+}
+
+// keys are already well mixed, so maps keyed by them skip std::hash
+struct KeyHash
+{
+    size_t operator()(const uint64_t key) const noexcept { return static_cast<size_t>(key ^ (key >> 32)); }
+};
+
+// "ref<Player>" -> "Player"; empty for non-reference types
+inline std::string reference_target(const std::string &type_name)
+{
+    if (type_name.size() > 5 && type_name.compare(0, 4, "ref<") == 0 && type_name.back() == '>')
+    {
+        return type_name.substr(4, type_name.size() - 5);
+    }
+
+    return "";
+}
+
+// bit flags behind the DSL's @attributes; a type's own attributes apply to
+// each property it declares
+struct PropertyAttributes
+{
+    static constexpr uint32_t None = 0;
+    static constexpr uint32_t Replicated = 1u << 0;
+    static constexpr uint32_t Persistent = 1u << 1;
+    static constexpr uint32_t EditorOnly = 1u << 2;
+    static constexpr uint32_t Transient = 1u << 3;
+
+    // "replicated" -> Replicated; None for names it does not know
+    static constexpr uint32_t from_name(const std::string_view name)
+    {
+        if (name == "replicated") return Replicated;
+        if (name == "persistent") return Persistent;
+        if (name == "editor_only") return EditorOnly;
+        if (name == "transient") return Transient;
+        return None;
+    }
+
+    static std::string to_string(const uint32_t attributes)
+    {
+        constexpr std::pair<uint32_t, const char *> names[] = {
+            {Replicated, "replicated"}, {Persistent, "persistent"}, {EditorOnly, "editor_only"}, {Transient, "transient"}};
+
+        std::string text;
+        for (const auto &[flag, name] : names)
+        {
+            if (!(attributes & flag)) continue;
+            if (!text.empty()) text += ' ';
+            text += '@';
+            text += name;
+        }
+        return text;
+    }
+};
+
+// values of the DSL's parameterized attributes, e.g. @history(8)
+struct AttributeArguments
+{
+    uint32_t history_depth = 0; // ticks kept by StoreHistory; 0 = not tracked
+    bool has_range = false;     // @range(min, max), inclusive; see ConstraintValidator
+    double range_min = 0.0;
+    double range_max = 0.0;
+};
+
+struct PropertyDescriptor
+{
+    std::string name;
+    std::string type_name;
+    PropertyValue default_value;
+    bool is_inherited = false;
+    uint32_t attributes = PropertyAttributes::None;
+    AttributeArguments arguments;
+
+    PropertyDescriptor(std::string n, std::string t, PropertyValue def = {}) :
+        name(std::move(n)), type_name(std::move(t)), default_value(std::move(def))
+    {
+    }
+};
+
+// a callable bound to a type. The invoker gets the object and the
+// arguments and returns nullopt when their count or types do not match the
+// signature; void methods return a default PropertyValue.
+struct MethodDescriptor
+{
+    using Invoker =
+        std::function<std::optional<PropertyValue>(DynamicObject &self, const std::vector<PropertyValue> &args)>;
+
+    std::string name;
+    std::string return_type;                  // "void" or a property type name
+    std::vector<std::string> parameter_types; // "int", "double", "string", "bool", "ref"
+    Invoker invoker;
+};
+
+// DSL name of a C++ method parameter or return type
+template <typename T>
+constexpr const char *method_type_name()
+{
+    if constexpr (std::is_void_v<T>) return "void";
+    else if constexpr (std::is_same_v<T, int>) return "int";
+    else if constexpr (std::is_same_v<T, double>) return "double";
+    else if constexpr (std::is_same_v<T, std::string>) return "string";
+    else if constexpr (std::is_same_v<T, bool>) return "bool";
+    else if constexpr (std::is_same_v<T, ObjectHandle>) return "ref";
+    else static_assert(sizeof(T) == 0, "method types must be PropertyValue alternatives or void");
+}
+
+template <typename R, typename... Args>
+struct MethodBinder
+{
+    template <typename Func>
+    static MethodDescriptor bind(std::string name, Func func)
+    {
+        MethodDescriptor method;
+        method.name = std::move(name);
+        method.return_type = method_type_name<std::decay_t<R>>();
+        method.parameter_types = {method_type_name<std::decay_t<Args>>()...};
+        method.invoker = [func = std::move(func)](DynamicObject &self, const std::vector<PropertyValue> &args) mutable
+        { return call(func, self, args, std::index_sequence_for<Args...>()); };
+        return method;
+    }
+
+private:
+    template <typename Func, size_t... I>
+    static std::optional<PropertyValue> call(Func &func, DynamicObject &self, const std::vector<PropertyValue> &args,
+                                             std::index_sequence<I...>)
+    {
+        if (args.size() != sizeof...(Args)) return std::nullopt;
+        if (!(std::holds_alternative<std::decay_t<Args>>(args[I]) && ...)) return std::nullopt;
+
+        if constexpr (std::is_void_v<R>)
+        {
+            func(self, std::get<std::decay_t<Args>>(args[I])...);
+            return PropertyValue();
+        }
+        else
+        {
+            return PropertyValue(func(self, std::get<std::decay_t<Args>>(args[I])...));
+        }
+    }
+};
+
+// signature of a method callable: a function pointer or a lambda taking
+// (DynamicObject &self, params...)
+template <typename Func>
+struct MethodTraits : MethodTraits<decltype(&Func::operator())>
+{
+};
+
+template <typename R, typename... Args>
+struct MethodTraits<R (*)(DynamicObject &, Args...)>
+{
+    using Binder = MethodBinder<R, Args...>;
+};
+
+template <typename C, typename R, typename... Args>
+struct MethodTraits<R (C::*)(DynamicObject &, Args...)>
+{
+    using Binder = MethodBinder<R, Args...>;
+};
+
+template <typename C, typename R, typename... Args>
+struct MethodTraits<R (C::*)(DynamicObject &, Args...) const>
+{
+    using Binder = MethodBinder<R, Args...>;
+};
+
+// reflects the callable's signature, e.g.
+// make_method("heal", [](DynamicObject &self, int amount) { ... return hp; })
+template <typename Func>
+[[nodiscard]] MethodDescriptor make_method(std::string name, Func func)
+{
+    return MethodTraits<std::decay_t<Func>>::Binder::bind(std::move(name), std::move(func));
+}
+
+class TypeDescriptor
+{
+public:
+    std::string type_name;
+    std::string base_type_name;
+    std::vector<PropertyDescriptor> properties;
+    std::vector<MethodDescriptor> methods;
+    uint32_t attributes = PropertyAttributes::None;
+    AttributeArguments arguments;
+
+    explicit TypeDescriptor(std::string name) : type_name(std::move(name)) {}
+
+    void add_property(const std::string &name, const std::string &type, PropertyValue default_val = {},
+                      const uint32_t attributes = PropertyAttributes::None)
+    {
+        properties.emplace_back(name, type, std::move(default_val));
+        properties.back().attributes = attributes;
+    }
+
+    // a native function or lambda taking (DynamicObject &self, params...);
+    // a method with a base type's name overrides it
+    template <typename Func>
+    void add_method(const std::string &name, Func func)
+    {
+        methods.push_back(make_method(name, std::move(func)));
+    }
+
+    void add_method(MethodDescriptor method) { methods.push_back(std::move(method)); }
+
+    void set_base_type(const std::string &base) { base_type_name = base; }
+};
+
+// one store or dynamic object using a type that belongs to a module; the
+// registry refuses to unload a module while any of its types is in use.
+// Types outside modules are never counted.
+class TypeUse
+{
+private:
+    std::atomic<int64_t> *counter_ = nullptr;
+
+    friend class TypeRegistry;
+
+    // takes over a count the registry already added
+    explicit TypeUse(std::atomic<int64_t> *counter) : counter_(counter) {}
+
+public:
+    TypeUse() = default;
+    TypeUse(const TypeUse &other) : counter_(other.counter_)
+    {
+        if (counter_) counter_->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    TypeUse &operator=(const TypeUse &other)
+    {
+        if (other.counter_) other.counter_->fetch_add(1, std::memory_order_relaxed);
+        if (counter_) counter_->fetch_sub(1, std::memory_order_release);
+        counter_ = other.counter_;
+        return *this;
+    }
+
+    ~TypeUse()
+    {
+        if (counter_) counter_->fetch_sub(1, std::memory_order_release);
+    }
+};
+
+struct ModuleUnloadResult
+{
+    bool ok = false;
+    size_t types = 0;          // types dropped
+    std::string blocking_type; // on failure: a module type still in use, or a type deriving from one
+};
+
+class TypeRegistry
+{
+public:
+    // produces the descriptor for a type that is not registered yet, or
+    // nullptr if it does not know the key; see SchemaLibrary
+    using TypeLoader = std::function<std::unique_ptr<TypeDescriptor>(uint64_t key)>;
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<TypeDescriptor>> types_;
+    std::unordered_map<uint64_t, const TypeDescriptor *, KeyHash> types_by_key_;
+    std::unordered_map<std::string, std::vector<std::string>> inheritance_graph_;
+    TypeLoader loader_;
+
+    // keys the loader could not provide; a repeated miss stays on the shared lock
+    std::unordered_set<uint64_t, KeyHash> failed_loads_;
+
+    // types registered through register_module, with their use counts
+    struct ModuleType
+    {
+        std::string module;
+        std::unique_ptr<std::atomic<int64_t>> uses;
+    };
+    std::unordered_map<std::string, std::vector<std::string>> modules_;
+    std::unordered_map<std::string, ModuleType> module_types_;
+
+    // lookups share the lock; registration and lazy loads take it exclusively
+    mutable std::shared_mutex mutex_;
+
+public:
+    static TypeRegistry &instance()
+    {
+        static TypeRegistry registry;
+        return registry;
+    }
+
+    // returns false (and registers nothing) when the type name or one of its
+    // property names collides with a different name under hash_name
+    bool register_type(std::unique_ptr<TypeDescriptor> type)
+    {
+        std::unique_lock lock(mutex_);
+        return register_unlocked(std::move(type));
+    }
+
+    // consulted on every lookup miss; types it returns are registered (bases
+    // first) and kept like any other
+    void set_type_loader(TypeLoader loader)
+    {
+        std::unique_lock lock(mutex_);
+        loader_ = std::move(loader);
+        failed_loads_.clear();
+    }
+
+    // registers `types` as one unit (a DLC, a level) that unload_module can
+    // drop again. Bases may come in any order. Nothing is registered if the
+    // module exists, a name is taken or a type fails register_type's checks.
+    bool register_module(const std::string &module, std::vector<std::unique_ptr<TypeDescriptor>> types)
+    {
+        std::unique_lock lock(mutex_);
+        if (module.empty() || modules_.count(module)) return false;
+
+        std::unordered_map<std::string, size_t> index;
+        for (size_t i = 0; i < types.size(); ++i)
+        {
+            if (!types[i] || find_unlocked(types[i]->type_name)) return false;
+            if (!index.try_emplace(types[i]->type_name, i).second) return false;
+        }
+
+        // bases inside the module first, so property checks see them
+        std::vector<std::string> names;
+        const std::function<bool(size_t)> add = [&](const size_t i)
+        {
+            if (!types[i]) return true; // done, or on the current base chain
+            auto type = std::move(types[i]);
+            if (const auto base = index.find(type->base_type_name); base != index.end() && !add(base->second))
+            {
+                return false;
+            }
+
+            auto name = type->type_name;
+            if (!register_unlocked(std::move(type))) return false;
+            names.push_back(std::move(name));
+            return true;
+        };
+
+        for (size_t i = 0; i < types.size(); ++i)
+        {
+            if (add(i)) continue;
+
+            for (const auto &name : names)
+            {
+                erase_unlocked(name);
+            }
+            return false;
+        }
+
+        for (const auto &name : names)
+        {
+            module_types_[name] = ModuleType{module, std::make_unique<std::atomic<int64_t>>(0)};
+        }
+        modules_[module] = std::move(names);
+        return true;
+    }
+
+    // drops every type of the module at once, provided no store or dynamic
+    // object of those types is alive and no type outside the module derives
+    // from one. Pointers to its descriptors are invalid afterwards.
+    ModuleUnloadResult unload_module(const std::string &module)
+    {
+        ModuleUnloadResult result;
+        std::unique_lock lock(mutex_);
+        const auto it = modules_.find(module);
+        if (it == modules_.end()) return result;
+
+        for (const auto &name : it->second)
+        {
+            if (module_types_.at(name).uses->load(std::memory_order_acquire) != 0)
+            {
+                result.blocking_type = name;
+                return result;
+            }
+        }
+
+        for (const auto &[name, type] : types_)
+        {
+            const auto base = module_types_.find(type->base_type_name);
+            const auto own = module_types_.find(name);
+            if (base != module_types_.end() && base->second.module == module &&
+                (own == module_types_.end() || own->second.module != module))
+            {
+                result.blocking_type = name;
+                return result;
+            }
+        }
+
+        for (const auto &name : it->second)
+        {
+            erase_unlocked(name);
+            module_types_.erase(name);
+        }
+        result.types = it->second.size();
+        result.ok = true;
+        modules_.erase(it);
+        return result;
+    }
+
+    [[nodiscard]] std::vector<std::string> get_module_types(const std::string &module) const
+    {
+        std::shared_lock lock(mutex_);
+        const auto it = modules_.find(module);
+        return it != modules_.end() ? it->second : std::vector<std::string>();
+    }
+
+    // counted only for module types; the count is taken under the lock so
+    // that unload_module cannot slip in between lookup and increment
+    [[nodiscard]] TypeUse use_type(const std::string &type_name) const
+    {
+        std::shared_lock lock(mutex_);
+        const auto it = module_types_.find(type_name);
+        if (it == module_types_.end()) return TypeUse();
+
+        it->second.uses->fetch_add(1, std::memory_order_relaxed);
+        return TypeUse(it->second.uses.get());
+    }
+
+    // binds a method to a type that is already registered, e.g. one loaded
+    // from a schema file. Do this during setup: descriptors are read without
+    // the lock, and MethodTables compiled earlier do not see the method.
+    bool add_method(const std::string &type_name, MethodDescriptor method)
+    {
+        std::unique_lock lock(mutex_);
+        const auto it = types_.find(type_name);
+        if (it == types_.end()) return false;
+
+        it->second->add_method(std::move(method));
+        return true;
+    }
+
+    [[nodiscard]] const TypeDescriptor *get_type(const std::string &name) const
+    {
+        if (name.empty()) return nullptr;
+
+        {
+            std::shared_lock lock(mutex_);
+            if (const auto type = find_unlocked(name)) return type;
+            if (!loader_ || failed_loads_.count(hash_name(name))) return nullptr;
+        }
+
+        // the loader works by key; a different name under the same hash is a miss
+        const auto type = load(hash_name(name));
+        return type && type->type_name == name ? type : nullptr;
+    }
+
+    // keys carry no name, so a hit cannot be told from a different name
+    // under the same hash; registration rejects such collisions
+    [[nodiscard]] const TypeDescriptor *get_type(const TypeKey key) const
+    {
+        {
+            std::shared_lock lock(mutex_);
+            if (const auto it = types_by_key_.find(key.hash); it != types_by_key_.end()) return it->second;
+            if (!loader_ || failed_loads_.count(key.hash)) return nullptr;
+        }
+
+        return load(key.hash);
+    }
+
+    [[nodiscard]] std::vector<PropertyDescriptor> get_all_properties(const std::string &type_name) const
+    {
+        // pulls in the whole base chain if it is not loaded yet
+        if (!get_type(type_name)) return {};
+
+        std::vector<PropertyDescriptor> all_props;
+        std::shared_lock lock(mutex_);
+        collect_properties_recursive(type_name, all_props);
+        return all_props;
+    }
+
+    // walks the base chain; a type counts as derived from itself
+    [[nodiscard]] bool is_derived_from(const std::string &type_name, const std::string &base_name) const
+    {
+        for (auto type = get_type(type_name); type; type = get_type(type->base_type_name))
+        {
+            if (type->type_name == base_name) return true;
+        }
+
+        return false;
+    }
+
+    // ref<T> targets (own and inherited) that are not registered yet
+    [[nodiscard]] std::vector<std::string> find_unresolved_references(const std::string &type_name) const
+    {
+        std::vector<std::string> unresolved;
+        for (const auto &prop : get_all_properties(type_name))
+        {
+            const auto target = reference_target(prop.type_name);
+            if (!target.empty() && !get_type(target))
+            {
+                unresolved.push_back(target);
+            }
+        }
+
+        return unresolved;
+    }
+
+private:
+    [[nodiscard]] const TypeDescriptor *find_unlocked(const std::string &name) const
+    {
+        const auto it = types_.find(name);
+        return it != types_.end() ? it->second.get() : nullptr;
+    }
+
+    void erase_unlocked(const std::string &name)
+    {
+        const auto it = types_.find(name);
+        if (it == types_.end()) return;
+
+        const auto key = types_by_key_.find(hash_name(name));
+        if (key != types_by_key_.end() && key->second == it->second.get())
+        {
+            types_by_key_.erase(key);
+        }
+        inheritance_graph_.erase(name);
+        types_.erase(it);
+    }
+
+    bool register_unlocked(std::unique_ptr<TypeDescriptor> type)
+    {
+        const auto &name = type->type_name;
+        const auto &base = type->base_type_name;
+        const auto key = hash_name(name);
+
+        if (const auto it = types_by_key_.find(key); it != types_by_key_.end() && it->second->type_name != name)
+        {
+            return false;
+        }
+        if (!has_unique_property_keys(*type)) return false;
+
+        if (!base.empty())
+        {
+            inheritance_graph_[name].push_back(base);
+        }
+
+        auto &slot = types_[name];
+        slot = std::move(type);
+        types_by_key_[key] = slot.get();
+        failed_loads_.erase(key);
+        return true;
+    }
+
+    // the exclusive lock both serializes the loader and deduplicates: a
+    // thread that lost the race finds the type already registered
+    // loading only fills in what lookups already promised to see, so const
+    // lookups may trigger it
+    const TypeDescriptor *load(const uint64_t key) const
+    {
+        std::unique_lock lock(mutex_);
+        return const_cast<TypeRegistry *>(this)->load_unlocked(key, 0);
+    }
+
+    const TypeDescriptor *load_unlocked(const uint64_t key, const size_t depth)
+    {
+        if (const auto it = types_by_key_.find(key); it != types_by_key_.end()) return it->second;
+
+        // a base cycle in the library would otherwise recurse forever
+        constexpr size_t max_base_depth = 64;
+        if (!loader_ || depth > max_base_depth || failed_loads_.count(key)) return nullptr;
+
+        // lookups are const and must not throw; a loader that does counts as a miss
+        std::unique_ptr<TypeDescriptor> type;
+        try
+        {
+            type = loader_(key);
+        }
+        catch (const std::exception &)
+        {
+        }
+        if (!type || hash_name(type->type_name) != key)
+        {
+            failed_loads_.insert(key);
+            return nullptr;
+        }
+
+        if (!type->base_type_name.empty() && !find_unlocked(type->base_type_name))
+        {
+            load_unlocked(hash_name(type->base_type_name), depth + 1);
+        }
+
+        const auto name = type->type_name;
+        if (register_unlocked(std::move(type))) return find_unlocked(name);
+
+        failed_loads_.insert(key);
+        return nullptr;
+    }
+
+    // own properties plus whatever the (already registered) bases declare;
+    // redeclaring the same name is an override, not a collision
+    [[nodiscard]] bool has_unique_property_keys(const TypeDescriptor &type) const
+    {
+        std::unordered_map<uint64_t, const std::string *, KeyHash> seen;
+        std::vector<PropertyDescriptor> props;
+        collect_properties_recursive(type.base_type_name, props);
+        props.insert(props.end(), type.properties.begin(), type.properties.end());
+
+        for (const auto &prop : props)
+        {
+            const auto [it, inserted] = seen.try_emplace(hash_name(prop.name), &prop.name);
+            if (!inserted && *it->second != prop.name) return false;
+        }
+
+        return true;
+    }
+
+    void collect_properties_recursive(const std::string &type_name, std::vector<PropertyDescriptor> &props) const
+    {
+        const auto type = find_unlocked(type_name);
+        if (!type) return;
+
+        if (!type->base_type_name.empty())
+        {
+            collect_properties_recursive(type->base_type_name, props);
+        }
+
+        for (const auto &prop : type->properties)
+        {
+            props.push_back(prop);
+            // type-level @history and @range apply to properties without their own
+            auto &arguments = props.back().arguments;
+            props.back().attributes |= type->attributes;
+            if (!arguments.history_depth)
+            {
+                arguments.history_depth = type->arguments.history_depth;
+            }
+            if (!arguments.has_range && type->arguments.has_range)
+            {
+                arguments.has_range = true;
+                arguments.range_min = type->arguments.range_min;
+                arguments.range_max = type->arguments.range_max;
+            }
+        }
+    }
+};
+
+// slots whose attributes include all of `required` and none of `excluded`;
+// consumers resolve this once per type and iterate only those slots
+inline std::vector<size_t> select_slots(const std::vector<PropertyDescriptor> &layout, const uint32_t required,
+                                        const uint32_t excluded = PropertyAttributes::None)
+{
+    std::vector<size_t> slots;
+    for (size_t slot = 0; slot < layout.size(); ++slot)
+    {
+        const uint32_t attributes = layout[slot].attributes;
+        if ((attributes & required) == required && !(attributes & excluded)) slots.push_back(slot);
+    }
+    return slots;
+}
+
+// index of a method in a MethodTable. Tables lay out a base type's methods
+// first and overrides reuse the base's index, so an id resolved on a base
+// type's table is valid on the table of every derived type.
+using MethodId = uint32_t;
+
+// a type's methods, own and inherited, flattened into one array with
+// overrides resolved at compile time: a call is an index plus one
+// indirect call, with no name lookup once the id is known
+class MethodTable
+{
+private:
+    std::string type_name_;
+    std::vector<MethodDescriptor> methods_;
+    std::unordered_map<uint64_t, MethodId, KeyHash> ids_;
+
+    MethodTable() = default;
+
+public:
+    // nullopt if the type is not registered, two method names share a key or
+    // an override changes the return or parameter types of the base method
+    [[nodiscard]] static std::optional<MethodTable> compile(const std::string &type_name)
+    {
+        std::vector<const TypeDescriptor *> chain;
+        for (auto type = TypeRegistry::instance().get_type(type_name); type;
+             type = TypeRegistry::instance().get_type(type->base_type_name))
+        {
+            chain.push_back(type);
+        }
+        if (chain.empty()) return std::nullopt;
+
+        MethodTable table;
+        table.type_name_ = type_name;
+        for (auto type = chain.rbegin(); type != chain.rend(); ++type)
+        {
+            for (const auto &method : (*type)->methods)
+            {
+                const auto id = static_cast<MethodId>(table.methods_.size());
+                const auto [it, inserted] = table.ids_.try_emplace(hash_name(method.name), id);
+                if (inserted)
+                {
+                    table.methods_.push_back(method);
+                }
+                else if (const auto &base = table.methods_[it->second];
+                         base.name == method.name && base.return_type == method.return_type &&
+                         base.parameter_types == method.parameter_types)
+                {
+                    table.methods_[it->second] = method;
+                }
+                else
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+
+        return table;
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+    [[nodiscard]] size_t size() const { return methods_.size(); }
+    [[nodiscard]] const MethodDescriptor &get_method(const MethodId id) const { return methods_[id]; }
+
+    [[nodiscard]] std::optional<MethodId> find(const std::string_view name) const
+    {
+        const auto it = ids_.find(hash_name(name));
+        return it != ids_.end() && methods_[it->second].name == name ? std::optional<MethodId>(it->second)
+                                                                     : std::nullopt;
+    }
+
+    // `self` should be of the table's type or derived from it. nullopt for
+    // an unknown id or arguments that do not match the signature.
+    std::optional<PropertyValue> invoke(DynamicObject &self, const MethodId id,
+                                        const std::vector<PropertyValue> &args = {}) const
+    {
+        if (id >= methods_.size()) return std::nullopt;
+        return methods_[id].invoker(self, args);
+    }
+
+    std::optional<PropertyValue> invoke(DynamicObject &self, const std::string_view name,
+                                        const std::vector<PropertyValue> &args = {}) const
+    {
+        const auto id = find(name);
+        return id ? invoke(self, *id, args) : std::nullopt;
+    }
+};
+
+class DynamicObject
+{
+private:
+    // keyed by hash_name so PropertyKey lookups skip hashing; the name is
+    // kept for enumeration and to verify string lookups. Defaults copied from
+    // the type are flagged so a prototype can take their place.
+    struct NamedValue
+    {
+        std::string name;
+        PropertyValue value;
+        bool is_default = false;
+
+        NamedValue(std::string n, PropertyValue v, const bool d = false) :
+            name(std::move(n)), value(std::move(v)), is_default(d)
+        {
+        }
+    };
+
+    // every key the prototype chain provides, flattened to the entry of the
+    // first link that has it. Built whole and never modified after it is
+    // published, so concurrent const reads can share it.
+    struct ResolvedSlots
+    {
+        uint64_t stamp = 0;
+        std::unordered_map<uint64_t, const NamedValue *, KeyHash> slots;
+    };
+
+    std::string type_name_;
+    TypeUse type_use_;
+    std::unordered_map<uint64_t, NamedValue, KeyHash> properties_;
+    std::shared_ptr<const DynamicObject> prototype_;
+    // bumped when a key is added or removed here or the object is relinked;
+    // entry addresses stay put otherwise, so plain value writes need not
+    uint64_t revision_ = next_revision();
+
+    // swapped with std::atomic_load/atomic_store only
+    mutable std::shared_ptr<const ResolvedSlots> resolved_;
+
+public:
+    // starts out with the type's defaults; they stay local only until a
+    // prototype is set, see set_prototype
+    explicit DynamicObject(std::string type_name) :
+        type_name_(std::move(type_name)), type_use_(TypeRegistry::instance().use_type(type_name_))
+    {
+        add_missing_defaults();
+    }
+
+    // a variant of a configured instance: nothing is copied, every read
+    // falls through to the prototype until the property is set locally
+    explicit DynamicObject(std::shared_ptr<const DynamicObject> prototype) :
+        type_name_(prototype->type_name_), type_use_(prototype->type_use_), prototype_(std::move(prototype))
+    {
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+    [[nodiscard]] const std::shared_ptr<const DynamicObject> &get_prototype() const { return prototype_; }
+
+    // the prototype has to be of this type or one of its bases, and must not
+    // already delegate back to this object. Type defaults the prototype chain
+    // also provides are dropped so reads delegate to it; values set on this
+    // object stay. Clearing the prototype brings back the type defaults.
+    bool set_prototype(std::shared_ptr<const DynamicObject> prototype)
+    {
+        if (prototype)
+        {
+            if (!TypeRegistry::instance().is_derived_from(type_name_, prototype->type_name_) &&
+                type_name_ != prototype->type_name_)
+            {
+                return false;
+            }
+
+            for (auto link = prototype.get(); link; link = link->prototype_.get())
+            {
+                if (link == this) return false;
+            }
+        }
+
+        prototype_ = std::move(prototype);
+        revision_ = next_revision();
+        if (prototype_)
+        {
+            for (auto it = properties_.begin(); it != properties_.end();)
+            {
+                const bool delegated = it->second.is_default && find_in_chain(prototype_.get(), it->first);
+                it = delegated ? properties_.erase(it) : std::next(it);
+            }
+        }
+        else
+        {
+            add_missing_defaults();
+        }
+        return true;
+    }
+
+    // false only if the name collides with a different local name
+    template <typename T>
+    bool set_property(const std::string &name, const T &value)
+    {
+        const auto [it, inserted] = properties_.try_emplace(hash_name(name), name, PropertyValue());
+        if (!inserted && it->second.name != name) return false;
+
+        it->second.value = value;
+        it->second.is_default = false;
+        if (inserted) revision_ = next_revision();
+        return true;
+    }
+
+    // keys carry no name, so this can only override a property the object
+    // (or its prototype chain) already has
+    template <typename T>
+    bool set_property(const PropertyKey key, const T &value)
+    {
+        if (const auto it = properties_.find(key.hash); it != properties_.end())
+        {
+            it->second.value = value;
+            it->second.is_default = false;
+        }
+        else if (const auto inherited = resolve(key.hash))
+        {
+            properties_.try_emplace(key.hash, inherited->name, PropertyValue(value));
+            revision_ = next_revision();
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    // drops the local value so reads delegate to the prototype again
+    bool clear_property(const std::string &name)
+    {
+        const auto it = properties_.find(hash_name(name));
+        if (it == properties_.end() || it->second.name != name) return false;
+
+        properties_.erase(it);
+        revision_ = next_revision();
+        return true;
+    }
+
+    [[nodiscard]] bool has_local_property(const std::string &name) const
+    {
+        const auto it = properties_.find(hash_name(name));
+        return it != properties_.end() && it->second.name == name;
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> get_property(const std::string &name) const
+    {
+        return typed_value<T>(find_property(name));
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> get_property(const PropertyKey key) const
+    {
+        return typed_value<T>(find_property(key));
+    }
+
+    [[nodiscard]] PropertyValue get_property_variant(const std::string &name) const
+    {
+        const auto value = find_property(name);
+        return value ? *value : PropertyValue();
+    }
+
+    [[nodiscard]] PropertyValue get_property_variant(const PropertyKey key) const
+    {
+        const auto value = find_property(key);
+        return value ? *value : PropertyValue();
+    }
+
+    // non-owning view of the resolved value; invalidated by any mutation on the chain
+    [[nodiscard]] const PropertyValue *find_property(const std::string &name) const
+    {
+        const auto entry = resolve(hash_name(name));
+        return entry && entry->name == name ? &entry->value : nullptr;
+    }
+
+    [[nodiscard]] const PropertyValue *find_property(const PropertyKey key) const
+    {
+        const auto entry = resolve(key.hash);
+        return entry ? &entry->value : nullptr;
+    }
+
+    [[nodiscard]] std::vector<std::string> get_property_names() const
+    {
+        std::vector<std::string> names;
+        std::unordered_map<uint64_t, bool, KeyHash> seen;
+        for (auto link = this; link; link = link->prototype_.get())
+        {
+            for (const auto &[key, entry] : link->properties_)
+            {
+                if (seen.try_emplace(key, true).second)
+                {
+                    names.push_back(entry.name);
+                }
+            }
+        }
+
+        return names;
+    }
+
+    [[nodiscard]] bool is_type(const std::string &type_name) const
+    {
+        if (type_name_ == type_name) return true;
+
+        const auto all_props = TypeRegistry::instance().get_all_properties(type_name_);
+        const auto target_props = TypeRegistry::instance().get_all_properties(type_name);
+
+        for (const auto &target_prop : target_props)
+        {
+            bool found = false;
+            for (const auto &our_prop : all_props)
+            {
+                if (our_prop.name == target_prop.name && our_prop.type_name == target_prop.type_name)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) return false;
+        }
+
+        return !target_props.empty();
+    }
+
+private:
+    void add_missing_defaults()
+    {
+        for (const auto &prop : TypeRegistry::instance().get_all_properties(type_name_))
+        {
+            properties_.try_emplace(hash_name(prop.name), prop.name, prop.default_value, true);
+        }
+    }
+
+    // revisions come from one global counter, so the newest revision on the
+    // chain moves forward whenever any link adds or drops a key or is relinked
+    static uint64_t next_revision()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // the entry for `key` in the first object along the chain from `link`
+    // that has one
+    static const NamedValue *find_in_chain(const DynamicObject *link, const uint64_t key)
+    {
+        for (; link; link = link->prototype_.get())
+        {
+            if (const auto it = link->properties_.find(key); it != link->properties_.end())
+            {
+                return &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    static std::optional<T> typed_value(const PropertyValue *value)
+    {
+        if (value && std::holds_alternative<T>(*value))
+        {
+            return std::get<T>(*value);
+        }
+
+        return std::nullopt;
+    }
+
+    // local values first, then the flattened table of the prototype chain.
+    // A stale table is rebuilt and republished rather than patched; threads
+    // racing to rebuild each publish an equivalent table.
+    [[nodiscard]] const NamedValue *resolve(const uint64_t key) const
+    {
+        if (const auto it = properties_.find(key); it != properties_.end())
+        {
+            return &it->second;
+        }
+        if (!prototype_) return nullptr;
+
+        uint64_t stamp = revision_;
+        for (auto link = prototype_.get(); link; link = link->prototype_.get())
+        {
+            stamp = std::max(stamp, link->revision_);
+        }
+
+        auto table = std::atomic_load(&resolved_);
+        if (!table || table->stamp != stamp)
+        {
+            auto rebuilt = std::make_shared<ResolvedSlots>();
+            rebuilt->stamp = stamp;
+            for (auto link = prototype_.get(); link; link = link->prototype_.get())
+            {
+                for (const auto &[entry_key, entry] : link->properties_)
+                {
+                    rebuilt->slots.try_emplace(entry_key, &entry);
+                }
+            }
+            table = std::move(rebuilt);
+            std::atomic_store(&resolved_, table);
+        }
+
+        const auto it = table->slots.find(key);
+        return it != table->slots.end() ? it->second : nullptr;
+    }
+};
+
+class ObjectFactory
+{
+public:
+    static std::unique_ptr<DynamicObject> create(const std::string &type_name)
+    {
+        if (const auto type_desc = TypeRegistry::instance().get_type(type_name); !type_desc)
+        {
+            return nullptr;
+        }
+
+        return std::make_unique<DynamicObject>(type_name);
+    }
+
+    static std::unique_ptr<DynamicObject> create(const TypeKey key)
+    {
+        const auto type_desc = TypeRegistry::instance().get_type(key);
+        return type_desc ? std::make_unique<DynamicObject>(type_desc->type_name) : nullptr;
+    }
+
+    static std::unique_ptr<DynamicObject> create_from_prototype(std::shared_ptr<const DynamicObject> prototype)
+    {
+        if (!prototype) return nullptr;
+
+        return std::make_unique<DynamicObject>(std::move(prototype));
+    }
+};
+
+// column alternatives line up with PropertyValue; bools are kept as bytes so
+// the column stays addressable
+using Column = std::variant<std::vector<int>, std::vector<double>, std::vector<std::string>, std::vector<uint8_t>,
+                            std::vector<ObjectHandle>>;
+
+enum class ValueKind : uint8_t
+{
+    Int = 0,
+    Double = 1,
+    String = 2,
+    Bool = 3,
+    Ref = 4,
+};
+
+inline ValueKind value_kind_for(const PropertyDescriptor &prop)
+{
+    if (prop.type_name == "int") return ValueKind::Int;
+    if (prop.type_name == "double") return ValueKind::Double;
+    if (prop.type_name == "string") return ValueKind::String;
+    if (prop.type_name == "bool") return ValueKind::Bool;
+    if (!reference_target(prop.type_name).empty()) return ValueKind::Ref;
+
+    return static_cast<ValueKind>(prop.default_value.index());
+}
+
+inline Column make_column(const ValueKind kind)
+{
+    switch (kind)
+    {
+    case ValueKind::Int:
+        return std::vector<int>();
+    case ValueKind::Double:
+        return std::vector<double>();
+    case ValueKind::String:
+        return std::vector<std::string>();
+    case ValueKind::Bool:
+        return std::vector<uint8_t>();
+    case ValueKind::Ref:
+        return std::vector<ObjectHandle>();
+    }
+
+    return std::vector<int>();
+}
+
+template <typename T>
+PropertyValue to_property_value(const T &element)
+{
+    if constexpr (std::is_same_v<T, uint8_t>)
+    {
+        return element != 0;
+    }
+    else
+    {
+        return element;
+    }
+}
+
+// columnar storage for many objects of one type; slot order follows
+// TypeRegistry::get_all_properties so base properties come first
+class ObjectStore
+{
+private:
+    struct HandleSlot
+    {
+        uint32_t row = 0;
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::string type_name_;
+    TypeUse type_use_;
+    std::vector<PropertyDescriptor> layout_;
+    std::unordered_map<std::string, size_t> slot_index_;
+    std::unordered_map<uint64_t, size_t, KeyHash> slot_keys_;
+    std::vector<Column> columns_;
+    std::vector<HandleSlot> handle_slots_;
+    std::vector<uint32_t> free_handles_;
+    std::vector<uint32_t> row_handles_;
+
+    // write versions: every mutation bumps version_ and stamps the chunk of
+    // rows it touched, so any number of consumers can ask "what changed
+    // since I last looked" without clearing flags under each other
+    std::vector<uint64_t> chunk_versions_;
+    uint64_t version_ = 0;
+    uint64_t structure_version_ = 0;
+
+public:
+    static constexpr size_t version_chunk_rows = 1024;
+
+    explicit ObjectStore(std::string type_name) :
+        type_name_(std::move(type_name)), type_use_(TypeRegistry::instance().use_type(type_name_))
+    {
+        layout_ = TypeRegistry::instance().get_all_properties(type_name_);
+        columns_.reserve(layout_.size());
+        for (size_t slot = 0; slot < layout_.size(); ++slot)
+        {
+            slot_index_[layout_[slot].name] = slot;
+            slot_keys_[hash_name(layout_[slot].name)] = slot;
+            columns_.push_back(make_column(value_kind_for(layout_[slot])));
+        }
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+    [[nodiscard]] const std::vector<PropertyDescriptor> &get_layout() const { return layout_; }
+    [[nodiscard]] size_t size() const { return row_handles_.size(); }
+    [[nodiscard]] size_t slot_count() const { return columns_.size(); }
+
+    [[nodiscard]] uint64_t version() const { return version_; }
+    // bumped when rows are added, removed or reordered
+    [[nodiscard]] uint64_t structure_version() const { return structure_version_; }
+    // version of the last write into each chunk of version_chunk_rows rows
+    [[nodiscard]] const std::vector<uint64_t> &chunk_versions() const { return chunk_versions_; }
+
+    [[nodiscard]] std::optional<size_t> find_slot(const std::string &name) const
+    {
+        const auto it = slot_index_.find(name);
+        return it != slot_index_.end() ? std::optional<size_t>(it->second) : std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<size_t> find_slot(const PropertyKey key) const
+    {
+        const auto it = slot_keys_.find(key.hash);
+        return it != slot_keys_.end() ? std::optional<size_t>(it->second) : std::nullopt;
+    }
+
+    void reserve(const size_t count)
+    {
+        row_handles_.reserve(count);
+        for (auto &column : columns_)
+        {
+            std::visit([count](auto &values) { values.reserve(count); }, column);
+        }
+    }
+
+    ObjectHandle create()
+    {
+        uint32_t index;
+        if (!free_handles_.empty())
+        {
+            index = free_handles_.back();
+            free_handles_.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(handle_slots_.size());
+            handle_slots_.emplace_back();
+        }
+
+        return append_row(index);
+    }
+
+    // true if create_at(handle) would succeed: the index is not in use and
+    // the generation does not bring back a handle this store already retired
+    [[nodiscard]] bool can_create_at(const ObjectHandle handle) const
+    {
+        if (!handle.is_valid()) return false;
+        if (handle.index >= handle_slots_.size()) return true;
+
+        const auto &entry = handle_slots_[handle.index];
+        return !entry.alive && handle.generation >= entry.generation;
+    }
+
+    // creates an object under exactly `handle` instead of the next free one,
+    // so another store's change set can be replayed; see StoreDiff::apply
+    bool create_at(const ObjectHandle handle)
+    {
+        if (!can_create_at(handle)) return false;
+
+        if (handle.index >= handle_slots_.size())
+        {
+            // indices skipped on the way are free, like destroyed ones
+            for (auto index = static_cast<uint32_t>(handle_slots_.size()); index < handle.index; ++index)
+            {
+                free_handles_.push_back(index);
+            }
+            handle_slots_.resize(static_cast<size_t>(handle.index) + 1);
+        }
+        else
+        {
+            free_handles_.erase(std::find(free_handles_.begin(), free_handles_.end(), handle.index));
+        }
+
+        handle_slots_[handle.index].generation = handle.generation;
+        append_row(handle.index);
+        return true;
+    }
+
+    // bulk create from one column per slot, all of the store's kinds and of
+    // equal length; values are moved in and the new rows get fresh handles
+    // in order. Nothing is appended on a shape mismatch.
+    bool append_columns(std::vector<Column> &&batch)
+    {
+        if (batch.size() != columns_.size()) return false;
+        if (batch.empty()) return true;
+
+        const size_t count = std::visit([](const auto &values) { return values.size(); }, batch[0]);
+        for (size_t slot = 0; slot < batch.size(); ++slot)
+        {
+            if (batch[slot].index() != columns_[slot].index() ||
+                std::visit([](const auto &values) { return values.size(); }, batch[slot]) != count)
+            {
+                return false;
+            }
+        }
+
+        for (size_t slot = 0; slot < batch.size(); ++slot)
+        {
+            std::visit(
+                [&](auto &values)
+                {
+                    auto &incoming = std::get<std::decay_t<decltype(values)>>(batch[slot]);
+                    values.insert(values.end(), std::make_move_iterator(incoming.begin()),
+                                  std::make_move_iterator(incoming.end()));
+                },
+                columns_[slot]);
+        }
+
+        const size_t first_row = row_handles_.size();
+        row_handles_.reserve(row_handles_.size() + count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t index;
+            if (!free_handles_.empty())
+            {
+                index = free_handles_.back();
+                free_handles_.pop_back();
+            }
+            else
+            {
+                index = static_cast<uint32_t>(handle_slots_.size());
+                handle_slots_.emplace_back();
+            }
+
+            auto &entry = handle_slots_[index];
+            entry.row = static_cast<uint32_t>(row_handles_.size());
+            entry.alive = true;
+            row_handles_.push_back(index);
+        }
+
+        ++structure_version_;
+        touch_rows(first_row, row_handles_.size());
+        return true;
+    }
+
+    bool destroy(const ObjectHandle handle)
+    {
+        if (!is_alive(handle)) return false;
+
+        auto &entry = handle_slots_[handle.index];
+        const uint32_t row = entry.row;
+        const uint32_t last = static_cast<uint32_t>(row_handles_.size() - 1);
+
+        // swap-remove keeps the columns dense
+        for (auto &column : columns_)
+        {
+            std::visit(
+                [&](auto &values)
+                {
+                    if (row != last) values[row] = std::move(values[last]);
+                    values.pop_back();
+                },
+                column);
+        }
+
+        if (row != last)
+        {
+            row_handles_[row] = row_handles_[last];
+            handle_slots_[row_handles_[row]].row = row;
+        }
+        row_handles_.pop_back();
+        ++structure_version_;
+        touch_rows(row, row + 1);
+
+        entry.alive = false;
+        ++entry.generation;
+        free_handles_.push_back(handle.index);
+        return true;
+    }
+
+    [[nodiscard]] bool is_alive(const ObjectHandle handle) const
+    {
+        return handle.index < handle_slots_.size() && handle_slots_[handle.index].alive &&
+               handle_slots_[handle.index].generation == handle.generation;
+    }
+
+    [[nodiscard]] std::optional<size_t> row_of(const ObjectHandle handle) const
+    {
+        if (!is_alive(handle)) return std::nullopt;
+        return handle_slots_[handle.index].row;
+    }
+
+    [[nodiscard]] ObjectHandle handle_at(const size_t row) const
+    {
+        const uint32_t index = row_handles_[row];
+        return {index, handle_slots_[index].generation};
+    }
+
+    [[nodiscard]] PropertyValue get_value(const size_t row, const size_t slot) const
+    {
+        return std::visit([row](const auto &values) { return to_property_value(values[row]); }, columns_[slot]);
+    }
+
+    bool set_value(const size_t row, const size_t slot, const PropertyValue &value)
+    {
+        if (value.index() != columns_[slot].index()) return false;
+
+        std::visit(
+            [&](auto &values)
+            {
+                using Elem = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (std::is_same_v<Elem, uint8_t>)
+                {
+                    values[row] = std::get<bool>(value) ? 1 : 0;
+                }
+                else
+                {
+                    values[row] = std::get<Elem>(value);
+                }
+            },
+            columns_[slot]);
+        touch_rows(row, row + 1);
+        return true;
+    }
+
+    // moves string payloads into the column instead of copying them
+    bool set_value(const size_t row, const size_t slot, PropertyValue &&value)
+    {
+        if (auto *text = std::get_if<std::string>(&value))
+        {
+            auto *values = std::get_if<std::vector<std::string>>(&columns_[slot]);
+            if (!values) return false;
+
+            (*values)[row] = std::move(*text);
+            touch_rows(row, row + 1);
+            return true;
+        }
+
+        return set_value(row, slot, static_cast<const PropertyValue &>(value));
+    }
+
+    template <typename T>
+    bool set_property(const ObjectHandle handle, const std::string &name, const T &value)
+    {
+        return set_slot(handle, find_slot(name), PropertyValue(value));
+    }
+
+    template <typename T>
+    bool set_property(const ObjectHandle handle, const PropertyKey key, const T &value)
+    {
+        return set_slot(handle, find_slot(key), PropertyValue(value));
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> get_property(const ObjectHandle handle, const std::string &name) const
+    {
+        return typed_slot<T>(handle, find_slot(name));
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> get_property(const ObjectHandle handle, const PropertyKey key) const
+    {
+        return typed_slot<T>(handle, find_slot(key));
+    }
+
+    [[nodiscard]] PropertyValue get_property_variant(const ObjectHandle handle, const std::string &name) const
+    {
+        const auto row = row_of(handle);
+        const auto slot = find_slot(name);
+        return row && slot ? get_value(*row, *slot) : PropertyValue();
+    }
+
+    [[nodiscard]] PropertyValue get_property_variant(const ObjectHandle handle, const PropertyKey key) const
+    {
+        const auto row = row_of(handle);
+        const auto slot = find_slot(key);
+        return row && slot ? get_value(*row, *slot) : PropertyValue();
+    }
+
+    // checked ref<T> assignment: the target must be alive in a store whose
+    // type is T or derives from it
+    bool set_reference(const ObjectHandle handle, const std::string &name, const ObjectStore &target_store,
+                       const ObjectHandle target)
+    {
+        const auto slot = find_slot(name);
+        if (!slot || !target_store.is_alive(target)) return false;
+
+        const auto target_type = reference_target(layout_[*slot].type_name);
+        if (target_type.empty() ||
+            !TypeRegistry::instance().is_derived_from(target_store.get_type_name(), target_type))
+        {
+            return false;
+        }
+
+        return set_property(handle, name, target);
+    }
+
+    [[nodiscard]] const Column &get_column(const size_t slot) const { return columns_[slot]; }
+
+    // in-place access for bulk kernels, which may run on several threads.
+    // The column's kind and length must not change, and nothing is stamped:
+    // call mark_written for the rows afterwards, from one thread.
+    [[nodiscard]] Column &get_column_for_write(const size_t slot) { return columns_[slot]; }
+    void mark_written(const size_t begin, const size_t end) { touch_rows(begin, std::min(end, row_handles_.size())); }
+
+    // order[i] is the current row that should end up at row i; handles keep
+    // pointing at the same objects afterwards. Nothing moves unless order
+    // names every row exactly once.
+    bool apply_permutation(const std::vector<uint32_t> &order)
+    {
+        if (order.size() != row_handles_.size()) return false;
+
+        std::vector<bool> seen(order.size());
+        for (const uint32_t row : order)
+        {
+            if (row >= order.size() || seen[row]) return false;
+            seen[row] = true;
+        }
+
+        for (auto &column : columns_)
+        {
+            std::visit(
+                [&](auto &values)
+                {
+                    std::decay_t<decltype(values)> reordered;
+                    reordered.reserve(values.size());
+                    for (const uint32_t row : order)
+                    {
+                        reordered.push_back(std::move(values[row]));
+                    }
+                    values.swap(reordered);
+                },
+                column);
+        }
+
+        std::vector<uint32_t> reordered_handles;
+        reordered_handles.reserve(order.size());
+        for (const uint32_t row : order)
+        {
+            reordered_handles.push_back(row_handles_[row]);
+        }
+        row_handles_.swap(reordered_handles);
+
+        for (uint32_t row = 0; row < row_handles_.size(); ++row)
+        {
+            handle_slots_[row_handles_[row]].row = row;
+        }
+
+        ++structure_version_;
+        touch_rows(0, row_handles_.size());
+        return true;
+    }
+
+    // the slot's declared default as stored in its column
+    template <typename Elem>
+    [[nodiscard]] Elem default_element(const size_t slot) const
+    {
+        const auto &def = layout_[slot].default_value;
+        if constexpr (std::is_same_v<Elem, uint8_t>)
+        {
+            return std::holds_alternative<bool>(def) && std::get<bool>(def) ? 1 : 0;
+        }
+        else
+        {
+            return std::holds_alternative<Elem>(def) ? std::get<Elem>(def) : Elem();
+        }
+    }
+
+private:
+    // puts a default-valued object at the end of the columns under `index`
+    ObjectHandle append_row(const uint32_t index)
+    {
+        auto &entry = handle_slots_[index];
+        entry.row = static_cast<uint32_t>(row_handles_.size());
+        entry.alive = true;
+        row_handles_.push_back(index);
+        ++structure_version_;
+        touch_rows(entry.row, entry.row + 1);
+
+        for (size_t slot = 0; slot < columns_.size(); ++slot)
+        {
+            std::visit(
+                [&](auto &values)
+                {
+                    using Elem = typename std::decay_t<decltype(values)>::value_type;
+                    values.push_back(default_element<Elem>(slot));
+                },
+                columns_[slot]);
+        }
+
+        return {index, entry.generation};
+    }
+
+    void touch_rows(const size_t begin, const size_t end)
+    {
+        if (begin >= end) return;
+
+        const size_t last_chunk = (end - 1) / version_chunk_rows;
+        if (last_chunk >= chunk_versions_.size()) chunk_versions_.resize(last_chunk + 1, 0);
+
+        ++version_;
+        for (size_t chunk = begin / version_chunk_rows; chunk <= last_chunk; ++chunk)
+        {
+            chunk_versions_[chunk] = version_;
+        }
+    }
+
+    bool set_slot(const ObjectHandle handle, const std::optional<size_t> slot, const PropertyValue &value)
+    {
+        const auto row = row_of(handle);
+        return row && slot && set_value(*row, *slot, value);
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> typed_slot(const ObjectHandle handle, const std::optional<size_t> slot) const
+    {
+        const auto row = row_of(handle);
+        if (!row || !slot) return std::nullopt;
+
+        const auto value = get_value(*row, *slot);
+        if (std::holds_alternative<T>(value))
+        {
+            return std::get<T>(value);
+        }
+
+        return std::nullopt;
+    }
+};
+
+// splits [0, count) into one contiguous range per worker; small inputs stay
+// on the calling thread since spawning costs more than the work
+constexpr size_t parallel_min_rows = 1 << 16;
+
+inline size_t parallel_chunk_count(const size_t count)
+{
+    if (count < parallel_min_rows) return 1;
+
+    const size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    return std::min(workers, count / (parallel_min_rows / 2));
+}
+
+template <typename Func>
+void parallel_for_chunks(const size_t count, const size_t chunks, Func &&func)
+{
+    if (chunks <= 1)
+    {
+        func(size_t(0), size_t(0), count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    const size_t step = (count + chunks - 1) / chunks;
+    for (size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        const size_t begin = std::min(count, chunk * step);
+        const size_t end = std::min(count, begin + step);
+        workers.emplace_back([&func, chunk, begin, end] { func(chunk, begin, end); });
+    }
+
+    func(size_t(0), size_t(0), std::min(count, step));
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+struct PropertyAggregate
+{
+    size_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    [[nodiscard]] double mean() const { return count ? sum / static_cast<double>(count) : 0.0; }
+
+    void add(const double value)
+    {
+        min = count ? std::min(min, value) : value;
+        max = count ? std::max(max, value) : value;
+        sum += value;
+        ++count;
+    }
+
+    void merge(const PropertyAggregate &other)
+    {
+        if (!other.count) return;
+
+        min = count ? std::min(min, other.min) : other.min;
+        max = count ? std::max(max, other.max) : other.max;
+        sum += other.sum;
+        count += other.count;
+    }
+};
+
+class StoreAnalytics
+{
+public:
+    [[nodiscard]] static size_t count(const ObjectStore &store) { return store.size(); }
+
+    // numeric columns only (int, double, bool); strings and refs have nothing to sum
+    [[nodiscard]] static std::optional<PropertyAggregate> aggregate(const ObjectStore &store,
+                                                                    const std::string &property)
+    {
+        const auto slot = store.find_slot(property);
+        if (!slot) return std::nullopt;
+
+        return std::visit(
+            [&](const auto &values) -> std::optional<PropertyAggregate>
+            {
+                using Elem = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (!std::is_arithmetic_v<Elem>)
+                {
+                    return std::nullopt;
+                }
+                else
+                {
+                    const size_t chunks = parallel_chunk_count(values.size());
+                    std::vector<PropertyAggregate> partials(chunks);
+                    parallel_for_chunks(values.size(), chunks,
+                                        [&](const size_t chunk, const size_t begin, const size_t end)
+                                        { partials[chunk] = reduce_range(values.data() + begin, end - begin); });
+
+                    PropertyAggregate result;
+                    for (const auto &partial : partials)
+                    {
+                        result.merge(partial);
+                    }
+                    return result;
+                }
+            },
+            store.get_column(*slot));
+    }
+
+    [[nodiscard]] static std::optional<double> sum(const ObjectStore &store, const std::string &property)
+    {
+        const auto result = aggregate(store, property);
+        return result ? std::optional<double>(result->sum) : std::nullopt;
+    }
+
+    [[nodiscard]] static std::optional<double> min(const ObjectStore &store, const std::string &property)
+    {
+        const auto result = aggregate(store, property);
+        return result && result->count ? std::optional<double>(result->min) : std::nullopt;
+    }
+
+    [[nodiscard]] static std::optional<double> max(const ObjectStore &store, const std::string &property)
+    {
+        const auto result = aggregate(store, property);
+        return result && result->count ? std::optional<double>(result->max) : std::nullopt;
+    }
+
+    [[nodiscard]] static std::optional<double> mean(const ObjectStore &store, const std::string &property)
+    {
+        const auto result = aggregate(store, property);
+        return result && result->count ? std::optional<double>(result->mean()) : std::nullopt;
+    }
+
+    // e.g. group_by(players, "level", "health") -> mean health per level
+    [[nodiscard]] static std::map<PropertyValue, PropertyAggregate>
+    group_by(const ObjectStore &store, const std::string &key_property, const std::string &value_property)
+    {
+        std::map<PropertyValue, PropertyAggregate> groups;
+
+        const auto key_slot = store.find_slot(key_property);
+        const auto value_slot = store.find_slot(value_property);
+        if (!key_slot || !value_slot) return groups;
+
+        std::visit(
+            [&](const auto &keys, const auto &values)
+            {
+                using Key = typename std::decay_t<decltype(keys)>::value_type;
+                using Elem = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (std::is_arithmetic_v<Elem>)
+                {
+                    const size_t chunks = parallel_chunk_count(keys.size());
+                    std::vector<std::unordered_map<Key, PropertyAggregate>> partials(chunks);
+                    parallel_for_chunks(keys.size(), chunks,
+                                        [&](const size_t chunk, const size_t begin, const size_t end)
+                                        {
+                                            auto &local = partials[chunk];
+                                            for (size_t row = begin; row < end; ++row)
+                                            {
+                                                local[keys[row]].add(static_cast<double>(values[row]));
+                                            }
+                                        });
+
+                    for (const auto &partial : partials)
+                    {
+                        for (const auto &[key, aggregate] : partial)
+                        {
+                            groups[to_property_value(key)].merge(aggregate);
+                        }
+                    }
+                }
+            },
+            store.get_column(*key_slot), store.get_column(*value_slot));
+
+        return groups;
+    }
+
+private:
+    // four independent lanes break the dependency chain on sum/min/max so the
+    // compiler can keep several accumulators in flight (and vectorize ints)
+    template <typename T>
+    static PropertyAggregate reduce_range(const T *data, const size_t count)
+    {
+        using Acc = std::conditional_t<std::is_floating_point_v<T>, double, int64_t>;
+
+        PropertyAggregate result;
+        if (count == 0) return result;
+
+        Acc sums[4] = {};
+        T lows[4] = {data[0], data[0], data[0], data[0]};
+        T highs[4] = {data[0], data[0], data[0], data[0]};
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                const T value = data[i + lane];
+                sums[lane] += value;
+                lows[lane] = std::min(lows[lane], value);
+                highs[lane] = std::max(highs[lane], value);
+            }
+        }
+        for (; i < count; ++i)
+        {
+            sums[0] += data[i];
+            lows[0] = std::min(lows[0], data[i]);
+            highs[0] = std::max(highs[0], data[i]);
+        }
+
+        result.count = count;
+        result.sum = static_cast<double>(sums[0] + sums[1] + sums[2] + sums[3]);
+        result.min = static_cast<double>(std::min({lows[0], lows[1], lows[2], lows[3]}));
+        result.max = static_cast<double>(std::max({highs[0], highs[1], highs[2], highs[3]}));
+        return result;
+    }
+};
+
+struct ConstraintViolation
+{
+    ObjectHandle handle;
+    size_t slot;
+};
+
+// the type's @range constraints compiled into one typed column scan each,
+// with bounds converted to the column's element type up front. Blocks are
+// screened with a branch-free test and only failing blocks are walked row
+// by row, so clean data costs one pass the compiler can vectorize.
+class ConstraintValidator
+{
+private:
+    struct Check
+    {
+        size_t slot;
+        ValueKind kind;
+        int int_min;
+        int int_max;
+        double double_min;
+        double double_max;
+    };
+
+    static constexpr size_t block_rows = 256;
+
+    std::string type_name_;
+    std::vector<Check> checks_;
+
+    ConstraintValidator() = default;
+
+public:
+    // nullopt if the type is not registered. Constraints on non-numeric
+    // properties are ignored.
+    [[nodiscard]] static std::optional<ConstraintValidator> compile(const std::string &type_name)
+    {
+        if (!TypeRegistry::instance().get_type(type_name)) return std::nullopt;
+
+        ConstraintValidator validator;
+        validator.type_name_ = type_name;
+
+        const auto layout = TypeRegistry::instance().get_all_properties(type_name);
+        for (size_t slot = 0; slot < layout.size(); ++slot)
+        {
+            const auto &arguments = layout[slot].arguments;
+            const ValueKind kind = value_kind_for(layout[slot]);
+            if (!arguments.has_range || (kind != ValueKind::Int && kind != ValueKind::Double)) continue;
+
+            // int bounds are rounded inward; a range holding no int at all
+            // (e.g. 0.2..0.8) gets min > max, which rejects every value
+            constexpr double int_lowest = std::numeric_limits<int>::lowest();
+            constexpr double int_highest = std::numeric_limits<int>::max();
+            const double low = std::max(std::ceil(arguments.range_min), int_lowest);
+            const double high = std::min(std::floor(arguments.range_max), int_highest);
+            const bool empty = low > high;
+            validator.checks_.push_back({slot, kind, empty ? 1 : static_cast<int>(low),
+                                         empty ? 0 : static_cast<int>(high), arguments.range_min,
+                                         arguments.range_max});
+        }
+
+        return validator;
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+    [[nodiscard]] size_t constraint_count() const { return checks_.size(); }
+
+    // violations among rows [begin, end), grouped by chunk of rows and then
+    // by slot; e.g. validate(store, first_imported_row) after a bulk import.
+    // nullopt if the store holds a different type.
+    [[nodiscard]] std::optional<std::vector<ConstraintViolation>>
+    validate(const ObjectStore &store, const size_t begin = 0, size_t end = SIZE_MAX) const
+    {
+        if (store.get_type_name() != type_name_) return std::nullopt;
+
+        end = std::min(end, store.size());
+        std::vector<ConstraintViolation> violations;
+        if (begin >= end || checks_.empty()) return violations;
+
+        const size_t count = end - begin;
+        const size_t chunks = parallel_chunk_count(count);
+        std::vector<std::vector<ConstraintViolation>> partials(chunks);
+        parallel_for_chunks(count, chunks,
+                            [&](const size_t chunk, const size_t chunk_begin, const size_t chunk_end)
+                            {
+                                for (const auto &check : checks_)
+                                {
+                                    scan_check(store, check, begin + chunk_begin, begin + chunk_end, partials[chunk]);
+                                }
+                            });
+
+        for (auto &partial : partials)
+        {
+            violations.insert(violations.end(), partial.begin(), partial.end());
+        }
+        return violations;
+    }
+
+private:
+    static void scan_check(const ObjectStore &store, const Check &check, const size_t begin, const size_t end,
+                           std::vector<ConstraintViolation> &out)
+    {
+        if (check.kind == ValueKind::Int)
+        {
+            const auto &values = std::get<std::vector<int>>(store.get_column(check.slot));
+            scan_range(store, check.slot, values.data(), begin, end, check.int_min, check.int_max, out);
+        }
+        else
+        {
+            const auto &values = std::get<std::vector<double>>(store.get_column(check.slot));
+            scan_range(store, check.slot, values.data(), begin, end, check.double_min, check.double_max, out);
+        }
+    }
+
+    // branch-free so the screening loop vectorizes; NaN counts as out of range
+    template <typename T>
+    static bool out_of_range(const T value, const T min, const T max)
+    {
+        return (value < min) | (value > max) | (value != value);
+    }
+
+    template <typename T>
+    static void scan_range(const ObjectStore &store, const size_t slot, const T *values, const size_t begin,
+                           const size_t end, const T min, const T max, std::vector<ConstraintViolation> &out)
+    {
+        for (size_t block = begin; block < end; block += block_rows)
+        {
+            const size_t block_end = std::min(end, block + block_rows);
+
+            bool any = false;
+            for (size_t row = block; row < block_end; ++row)
+            {
+                any |= out_of_range(values[row], min, max);
+            }
+            if (!any) continue;
+
+            for (size_t row = block; row < block_end; ++row)
+            {
+                if (out_of_range(values[row], min, max)) out.push_back({store.handle_at(row), slot});
+            }
+        }
+    }
+};
+
+enum class SortOrder
+{
+    Ascending,
+    Descending,
+};
+
+class StoreSorter
+{
+public:
+    // returns the row permutation that orders the store by the property;
+    // the sort is stable, so ties keep their current relative order
+    [[nodiscard]] static std::vector<uint32_t> sort_by(const ObjectStore &store, const std::string &property,
+                                                       const SortOrder order = SortOrder::Ascending)
+    {
+        const auto slot = store.find_slot(property);
+        if (!slot) return {};
+
+        const bool descending = order == SortOrder::Descending;
+        return std::visit(
+            [&](const auto &values) -> std::vector<uint32_t>
+            {
+                using Elem = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (std::is_same_v<Elem, std::string>)
+                {
+                    return sort_strings(values, descending);
+                }
+                else if constexpr (std::is_same_v<Elem, double>)
+                {
+                    return sort_keys<uint64_t>(values, descending, &double_key);
+                }
+                else if constexpr (std::is_same_v<Elem, ObjectHandle>)
+                {
+                    // groups rows by referenced object, e.g. weapons by owner
+                    return sort_keys<uint32_t>(values, descending, [](const ObjectHandle ref) { return ref.index; });
+                }
+                else
+                {
+                    return sort_keys<uint32_t>(values, descending, &integer_key<Elem>);
+                }
+            },
+            store.get_column(*slot));
+    }
+
+    // physically reorders the columns so scans run in property order
+    static bool reorder_by(ObjectStore &store, const std::string &property, const SortOrder order = SortOrder::Ascending)
+    {
+        if (!store.find_slot(property)) return false;
+
+        return store.apply_permutation(sort_by(store, property, order));
+    }
+
+private:
+    template <typename Key>
+    struct SortRecord
+    {
+        Key key;
+        uint32_t row;
+    };
+
+    // order-preserving maps onto unsigned keys so one radix routine covers
+    // signed ints and doubles
+    template <typename T>
+    static uint32_t integer_key(const T value)
+    {
+        if constexpr (std::is_signed_v<T>)
+        {
+            return static_cast<uint32_t>(value) ^ 0x80000000u;
+        }
+        else
+        {
+            return static_cast<uint32_t>(value);
+        }
+    }
+
+    static uint64_t double_key(const double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        constexpr uint64_t sign = 1ull << 63;
+        return bits & sign ? ~bits : bits | sign;
+    }
+
+    template <typename Key, typename Elem, typename KeyFunc>
+    static std::vector<uint32_t> sort_keys(const std::vector<Elem> &values, const bool descending, KeyFunc key_of)
+    {
+        const size_t count = values.size();
+        std::vector<SortRecord<Key>> records(count);
+        for (size_t row = 0; row < count; ++row)
+        {
+            // complementing keeps equal keys in row order, so descending stays stable
+            const Key key = key_of(values[row]);
+            records[row] = {descending ? static_cast<Key>(~key) : key, static_cast<uint32_t>(row)};
+        }
+
+        std::vector<SortRecord<Key>> scratch(count);
+        const auto bounds = sort_runs(count,
+                                      [&](const size_t begin, const size_t end)
+                                      { radix_sort(records.data() + begin, scratch.data() + begin, end - begin); });
+
+        merge_runs(records, scratch, bounds, [](const auto &a, const auto &b) { return a.key < b.key; });
+
+        std::vector<uint32_t> permutation(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            permutation[i] = records[i].row;
+        }
+        return permutation;
+    }
+
+    static std::vector<uint32_t> sort_strings(const std::vector<std::string> &values, const bool descending)
+    {
+        std::vector<uint32_t> rows(values.size());
+        for (uint32_t row = 0; row < rows.size(); ++row)
+        {
+            rows[row] = row;
+        }
+
+        const auto less = [&](const uint32_t a, const uint32_t b)
+        { return descending ? values[b] < values[a] : values[a] < values[b]; };
+
+        std::vector<uint32_t> scratch(rows.size());
+        const auto bounds = sort_runs(rows.size(), [&](const size_t begin, const size_t end)
+                                      { std::stable_sort(rows.begin() + begin, rows.begin() + end, less); });
+
+        merge_runs(rows, scratch, bounds, less);
+        return rows;
+    }
+
+    // LSD radix over 8-bit digits; passes where every key shares the digit
+    // are skipped, which makes small-range keys (levels, flags) nearly free
+    template <typename Key>
+    static void radix_sort(SortRecord<Key> *records, SortRecord<Key> *scratch, const size_t count)
+    {
+        if (count < 2) return;
+
+        SortRecord<Key> *src = records;
+        SortRecord<Key> *dst = scratch;
+        for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += 8)
+        {
+            size_t offsets[256] = {};
+            for (size_t i = 0; i < count; ++i)
+            {
+                ++offsets[(src[i].key >> shift) & 0xFF];
+            }
+            if (std::find(std::begin(offsets), std::end(offsets), count) != std::end(offsets)) continue;
+
+            size_t total = 0;
+            for (auto &offset : offsets)
+            {
+                const size_t bucket = offset;
+                offset = total;
+                total += bucket;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != records) std::copy(src, src + count, records);
+    }
+
+    // sorts each per-thread run independently and returns the run bounds
+    template <typename SortRun>
+    static std::vector<size_t> sort_runs(const size_t count, SortRun &&sort_run)
+    {
+        const size_t chunks = parallel_chunk_count(count);
+        std::vector<size_t> bounds(chunks + 1, count);
+        const size_t step = (count + chunks - 1) / std::max<size_t>(chunks, 1);
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            bounds[chunk] = std::min(count, chunk * step);
+        }
+
+        parallel_for_chunks(count, chunks, [&](size_t, const size_t begin, const size_t end) { sort_run(begin, end); });
+        return bounds;
+    }
+
+    // pairwise merge of sorted runs, one thread per pair at each level
+    template <typename Record, typename Less>
+    static void merge_runs(std::vector<Record> &records, std::vector<Record> &scratch, std::vector<size_t> bounds,
+                           Less less)
+    {
+        while (bounds.size() > 2)
+        {
+            const size_t runs = bounds.size() - 1;
+            const size_t pairs = (runs + 1) / 2;
+            parallel_for_chunks(pairs, pairs,
+                                [&](size_t, const size_t first, const size_t last)
+                                {
+                                    for (size_t pair = first; pair < last; ++pair)
+                                    {
+                                        const size_t lo = bounds[pair * 2];
+                                        const size_t mid = bounds[std::min(pair * 2 + 1, runs)];
+                                        const size_t hi = bounds[std::min(pair * 2 + 2, runs)];
+                                        std::merge(records.begin() + lo, records.begin() + mid, records.begin() + mid,
+                                                   records.begin() + hi, scratch.begin() + lo, less);
+                                    }
+                                });
+
+            std::vector<size_t> merged;
+            for (size_t i = 0; i < bounds.size(); i += 2)
+            {
+                merged.push_back(bounds[i]);
+            }
+            if (merged.back() != bounds.back()) merged.push_back(bounds.back());
+
+            records.swap(scratch);
+            bounds.swap(merged);
+        }
+    }
+};
+
+struct JoinedPair
+{
+    ObjectHandle left;
+    ObjectHandle right;
+};
+
+class StoreJoin
+{
+public:
+    // index join over a ref<T> property: each reference resolves through the
+    // target's handle table, so this is one pass over the source column.
+    // Dangling or null references are dropped.
+    [[nodiscard]] static std::vector<JoinedPair> join(const ObjectStore &source, const std::string &ref_property,
+                                                      const ObjectStore &target)
+    {
+        const auto slot = source.find_slot(ref_property);
+        if (!slot) return {};
+
+        const auto target_type = reference_target(source.get_layout()[*slot].type_name);
+        if (target_type.empty() || !TypeRegistry::instance().is_derived_from(target.get_type_name(), target_type))
+        {
+            return {};
+        }
+
+        const auto &refs = std::get<std::vector<ObjectHandle>>(source.get_column(*slot));
+        return collect_parallel(refs.size(),
+                                [&](const size_t row, std::vector<JoinedPair> &out)
+                                {
+                                    if (target.is_alive(refs[row]))
+                                    {
+                                        out.push_back({source.handle_at(row), refs[row]});
+                                    }
+                                });
+    }
+
+    // equi-join on plain values, e.g. a legacy int owner_id against Player.id;
+    // builds a hash table over the right side and probes it with the left
+    [[nodiscard]] static std::vector<JoinedPair> hash_join(const ObjectStore &left, const std::string &left_property,
+                                                           const ObjectStore &right, const std::string &right_property)
+    {
+        const auto left_slot = left.find_slot(left_property);
+        const auto right_slot = right.find_slot(right_property);
+        if (!left_slot || !right_slot) return {};
+
+        const auto &left_column = left.get_column(*left_slot);
+        const auto &right_column = right.get_column(*right_slot);
+        if (left_column.index() != right_column.index()) return {};
+
+        return std::visit(
+            [&](const auto &right_values) -> std::vector<JoinedPair>
+            {
+                using Values = std::decay_t<decltype(right_values)>;
+                using Key = typename Values::value_type;
+                const auto &left_values = std::get<Values>(left_column);
+
+                // bucket heads plus a next-chain keep duplicate keys without a vector per key
+                constexpr uint32_t end_of_chain = UINT32_MAX;
+                std::unordered_map<Key, uint32_t> heads;
+                std::vector<uint32_t> next(right_values.size(), end_of_chain);
+                heads.reserve(right_values.size());
+                for (uint32_t row = static_cast<uint32_t>(right_values.size()); row-- > 0;)
+                {
+                    auto [it, inserted] = heads.try_emplace(right_values[row], row);
+                    if (!inserted)
+                    {
+                        next[row] = it->second;
+                        it->second = row;
+                    }
+                }
+
+                return collect_parallel(left_values.size(),
+                                        [&](const size_t row, std::vector<JoinedPair> &out)
+                                        {
+                                            const auto it = heads.find(left_values[row]);
+                                            if (it == heads.end()) return;
+
+                                            for (uint32_t match = it->second; match != end_of_chain;
+                                                 match = next[match])
+                                            {
+                                                out.push_back({left.handle_at(row), right.handle_at(match)});
+                                            }
+                                        });
+            },
+            right_column);
+    }
+
+private:
+    // per-thread output buffers concatenated in chunk order, so results come
+    // back in source row order regardless of thread count
+    template <typename Probe>
+    static std::vector<JoinedPair> collect_parallel(const size_t count, Probe &&probe)
+    {
+        const size_t chunks = parallel_chunk_count(count);
+        std::vector<std::vector<JoinedPair>> partials(chunks);
+        parallel_for_chunks(count, chunks,
+                            [&](const size_t chunk, const size_t begin, const size_t end)
+                            {
+                                for (size_t row = begin; row < end; ++row)
+                                {
+                                    probe(row, partials[chunk]);
+                                }
+                            });
+
+        std::vector<JoinedPair> pairs = std::move(partials[0]);
+        for (size_t chunk = 1; chunk < chunks; ++chunk)
+        {
+            pairs.insert(pairs.end(), partials[chunk].begin(), partials[chunk].end());
+        }
+        return pairs;
+    }
+};
+
+// one worker's queued writes to a store. Not synchronized: each worker
+// records into its own buffer; see DeferredWriteQueue.
+class CommandBuffer
+{
+private:
+    struct Command
+    {
+        ObjectHandle handle;
+        uint32_t slot;
+        PropertyValue value;
+    };
+
+    const ObjectStore *store_;
+    std::vector<Command> commands_;
+
+    friend class DeferredWriteQueue;
+
+public:
+    explicit CommandBuffer(const ObjectStore &store) : store_(&store) {}
+
+    // checked against the store only when applied
+    void set_value(const ObjectHandle handle, const size_t slot, PropertyValue value)
+    {
+        commands_.push_back({handle, static_cast<uint32_t>(slot), std::move(value)});
+    }
+
+    template <typename T>
+    bool set_property(const ObjectHandle handle, const std::string &name, const T &value)
+    {
+        const auto slot = store_->find_slot(name);
+        if (!slot) return false;
+
+        set_value(handle, *slot, PropertyValue(value));
+        return true;
+    }
+
+    template <typename T>
+    bool set_property(const ObjectHandle handle, const PropertyKey key, const T &value)
+    {
+        const auto slot = store_->find_slot(key);
+        if (!slot) return false;
+
+        set_value(handle, *slot, PropertyValue(value));
+        return true;
+    }
+
+    [[nodiscard]] size_t size() const { return commands_.size(); }
+};
+
+struct DeferredApplyResult
+{
+    size_t applied = 0;
+    size_t superseded = 0; // overwritten by a later command for the same value
+    size_t rejected = 0;   // dead handle, bad slot or wrong value type
+};
+
+// per-worker command buffers for writes to objects a worker does not own,
+// applied in one batch at a sync point. Give worker i buffer(i), e.g. the
+// chunk index from parallel_for_chunks; writes then need no locking.
+//
+// apply() orders commands by row and slot for locality. For the same
+// (object, slot) the last command wins, where "last" means highest buffer
+// index, then latest within that buffer: the outcome depends only on which
+// buffer each write went to, never on thread timing.
+class DeferredWriteQueue
+{
+private:
+    ObjectStore &store_;
+    std::vector<CommandBuffer> buffers_;
+
+public:
+    DeferredWriteQueue(ObjectStore &store, const size_t buffer_count) : store_(store)
+    {
+        buffers_.reserve(buffer_count);
+        for (size_t i = 0; i < buffer_count; ++i)
+        {
+            buffers_.emplace_back(store);
+        }
+    }
+
+    [[nodiscard]] size_t buffer_count() const { return buffers_.size(); }
+    CommandBuffer &buffer(const size_t index) { return buffers_[index]; }
+
+    // call with no worker recording; empties every buffer
+    DeferredApplyResult apply()
+    {
+        DeferredApplyResult result;
+
+        struct Pending
+        {
+            uint32_t row;
+            uint32_t slot;
+            CommandBuffer::Command *command;
+        };
+
+        std::vector<Pending> pending;
+        size_t total = 0;
+        for (const auto &buffer : buffers_)
+        {
+            total += buffer.commands_.size();
+        }
+        pending.reserve(total);
+
+        // buffer order, then record order: the stable sort below keeps it
+        // within each (row, slot)
+        for (auto &buffer : buffers_)
+        {
+            for (auto &command : buffer.commands_)
+            {
+                // rejected up front so an invalid write cannot supersede a valid one
+                const auto row = store_.row_of(command.handle);
+                if (!row || command.slot >= store_.slot_count() ||
+                    command.value.index() != store_.get_column(command.slot).index())
+                {
+                    ++result.rejected;
+                    continue;
+                }
+                pending.push_back({static_cast<uint32_t>(*row), command.slot, &command});
+            }
+        }
+
+        std::stable_sort(pending.begin(), pending.end(),
+                         [](const Pending &a, const Pending &b)
+                         { return a.row != b.row ? a.row < b.row : a.slot < b.slot; });
+
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            const bool overwritten =
+                i + 1 < pending.size() && pending[i + 1].row == pending[i].row && pending[i + 1].slot == pending[i].slot;
+            if (overwritten)
+            {
+                ++result.superseded;
+                continue;
+            }
+
+            store_.set_value(pending[i].row, pending[i].slot, std::move(pending[i].command->value));
+            ++result.applied;
+        }
+
+        for (auto &buffer : buffers_)
+        {
+            buffer.commands_.clear();
+        }
+        return result;
+    }
+};
+
+// one step of a StoreCursor: the matching rows of [begin, end). The rows
+// vector is reused from batch to batch, so scanning stays flat in memory.
+struct StoreBatch
+{
+    size_t begin = 0;
+    size_t end = 0;
+    std::vector<uint32_t> rows;
+};
+
+// pull-based scan over a store. next() yields matching handles one at a
+// time, next_batch() yields matching rows a batch at a time for column
+// access. Nothing is materialized up front, so consumers can stop early.
+// Rows are read lazily: create/destroy/reorder between pulls is tolerated
+// (the scan ends at the current size) but may skip or repeat objects.
+class StoreCursor
+{
+public:
+    static constexpr size_t default_batch_rows = 4096;
+
+    // appends the matching rows of [begin, end) to `out`; called once per
+    // batch so the per-row work stays inside one typed loop
+    using BatchFilter = std::function<void(size_t begin, size_t end, std::vector<uint32_t> &out)>;
+
+private:
+    const ObjectStore *store_;
+    BatchFilter filter_;
+    size_t batch_rows_;
+    size_t next_row_ = 0;
+    StoreBatch batch_;
+    size_t position_ = 0;
+
+public:
+    explicit StoreCursor(const ObjectStore &store, BatchFilter filter = {},
+                         const size_t batch_rows = default_batch_rows) :
+        store_(&store), filter_(std::move(filter)), batch_rows_(std::max<size_t>(1, batch_rows))
+    {
+    }
+
+    // every object whose `property` satisfies pred, e.g.
+    // StoreCursor::where<int>(players, "level", [](int l) { return l > 10; });
+    // nullopt if the property is missing or not of type T
+    template <typename T, typename Pred>
+    [[nodiscard]] static std::optional<StoreCursor> where(const ObjectStore &store, const std::string &property,
+                                                          Pred pred, const size_t batch_rows = default_batch_rows)
+    {
+        auto filter = where_filter<T>(store, property, std::move(pred));
+        if (!filter) return std::nullopt;
+
+        return StoreCursor(store, std::move(*filter), batch_rows);
+    }
+
+    // the filter behind where(); it reads the store's column directly, so it
+    // stays valid for the store's lifetime
+    template <typename T, typename Pred>
+    [[nodiscard]] static std::optional<BatchFilter> where_filter(const ObjectStore &store, const std::string &property,
+                                                                 Pred pred)
+    {
+        using Elem = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+
+        const auto slot = store.find_slot(property);
+        if (!slot || !std::holds_alternative<std::vector<Elem>>(store.get_column(*slot))) return std::nullopt;
+
+        const auto *values = &std::get<std::vector<Elem>>(store.get_column(*slot));
+        return BatchFilter(
+            [values, pred = std::move(pred)](const size_t begin, const size_t end, std::vector<uint32_t> &out)
+            {
+                for (size_t row = begin; row < end; ++row)
+                {
+                    if (pred(static_cast<T>((*values)[row]))) out.push_back(static_cast<uint32_t>(row));
+                }
+            });
+    }
+
+    // next batch with at least one match, or nullptr once the store is exhausted
+    const StoreBatch *next_batch()
+    {
+        position_ = 0;
+        while (next_row_ < store_->size())
+        {
+            batch_.begin = next_row_;
+            batch_.end = std::min(store_->size(), next_row_ + batch_rows_);
+            next_row_ = batch_.end;
+
+            batch_.rows.clear();
+            if (filter_)
+            {
+                filter_(batch_.begin, batch_.end, batch_.rows);
+            }
+            else
+            {
+                for (size_t row = batch_.begin; row < batch_.end; ++row)
+                {
+                    batch_.rows.push_back(static_cast<uint32_t>(row));
+                }
+            }
+
+            if (!batch_.rows.empty()) return &batch_;
+        }
+
+        batch_.rows.clear();
+        return nullptr;
+    }
+
+    std::optional<ObjectHandle> next()
+    {
+        while (position_ >= batch_.rows.size())
+        {
+            if (!next_batch()) return std::nullopt;
+        }
+
+        const uint32_t row = batch_.rows[position_++];
+        return row < store_->size() ? std::optional<ObjectHandle>(store_->handle_at(row)) : std::nullopt;
+    }
+
+    void reset()
+    {
+        next_row_ = 0;
+        position_ = 0;
+        batch_.rows.clear();
+    }
+};
+
+// objects entering and leaving a MaterializedView in one refresh()
+struct ViewDelta
+{
+    std::vector<ObjectHandle> entered;
+    std::vector<ObjectHandle> left;
+
+    [[nodiscard]] bool empty() const { return entered.empty() && left.empty(); }
+};
+
+// continuous query over a store, e.g. "players with health < 20":
+//
+//   auto low = MaterializedView::where<int>(players, "health", [](int hp) { return hp < 20; });
+//   low->subscribe([](const ViewDelta &delta) { ... });
+//   // once per frame, after the simulation step:
+//   low->refresh();
+//
+// refresh() re-evaluates the filter only on the chunks the store stamped as
+// written since the previous refresh (see ObjectStore::chunk_versions) and
+// turns membership changes into enter/leave deltas. Destroyed members
+// leave; the first refresh reports every match as entered.
+class MaterializedView
+{
+public:
+    using Subscriber = std::function<void(const ViewDelta &)>;
+
+private:
+    const ObjectStore *store_;
+    StoreCursor::BatchFilter filter_;
+    std::vector<ObjectHandle> members_;
+    std::vector<uint32_t> position_of_index_; // handle index -> position in members_
+    std::vector<std::pair<uint64_t, Subscriber>> subscribers_;
+    uint64_t next_subscriber_ = 1;
+    uint64_t synced_version_ = 0;
+    uint64_t synced_structure_ = 0;
+    std::vector<uint32_t> matches_;
+    ViewDelta delta_;
+
+public:
+    // `store` must outlive the view
+    MaterializedView(const ObjectStore &store, StoreCursor::BatchFilter filter) :
+        store_(&store), filter_(std::move(filter))
+    {
+    }
+
+    // nullopt if the property is missing or not of type T
+    template <typename T, typename Pred>
+    [[nodiscard]] static std::optional<MaterializedView> where(const ObjectStore &store, const std::string &property,
+                                                               Pred pred)
+    {
+        auto filter = StoreCursor::where_filter<T>(store, property, std::move(pred));
+        if (!filter) return std::nullopt;
+
+        return MaterializedView(store, std::move(*filter));
+    }
+
+    [[nodiscard]] const std::vector<ObjectHandle> &members() const { return members_; }
+    [[nodiscard]] size_t size() const { return members_.size(); }
+
+    [[nodiscard]] bool contains(const ObjectHandle handle) const
+    {
+        return handle.index < position_of_index_.size() && position_of_index_[handle.index] != UINT32_MAX &&
+               members_[position_of_index_[handle.index]] == handle;
+    }
+
+    // returns an id for unsubscribe()
+    uint64_t subscribe(Subscriber subscriber)
+    {
+        subscribers_.emplace_back(next_subscriber_, std::move(subscriber));
+        return next_subscriber_++;
+    }
+
+    bool unsubscribe(const uint64_t id)
+    {
+        const auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                                     [id](const auto &entry) { return entry.first == id; });
+        if (it == subscribers_.end()) return false;
+
+        subscribers_.erase(it);
+        return true;
+    }
+
+    // brings membership up to date and notifies subscribers when it changed;
+    // the returned delta is valid until the next refresh()
+    const ViewDelta &refresh()
+    {
+        delta_.entered.clear();
+        delta_.left.clear();
+        if (store_->version() == synced_version_) return delta_;
+
+        if (store_->structure_version() != synced_structure_)
+        {
+            // walk backwards since leave() swaps the last member into place
+            for (size_t i = members_.size(); i-- > 0;)
+            {
+                if (!store_->is_alive(members_[i])) leave(members_[i]);
+            }
+        }
+
+        const size_t rows = store_->size();
+        const auto &versions = store_->chunk_versions();
+        for (size_t chunk = 0; chunk < versions.size(); ++chunk)
+        {
+            const size_t begin = chunk * ObjectStore::version_chunk_rows;
+            if (begin >= rows) break;
+            if (versions[chunk] <= synced_version_) continue;
+
+            const size_t end = std::min(rows, begin + ObjectStore::version_chunk_rows);
+            matches_.clear();
+            filter_(begin, end, matches_);
+
+            size_t next_match = 0;
+            for (size_t row = begin; row < end; ++row)
+            {
+                const bool matched = next_match < matches_.size() && matches_[next_match] == row;
+                if (matched) ++next_match;
+
+                const ObjectHandle handle = store_->handle_at(row);
+                if (matched != contains(handle)) matched ? enter(handle) : leave(handle);
+            }
+        }
+
+        synced_version_ = store_->version();
+        synced_structure_ = store_->structure_version();
+
+        if (!delta_.empty())
+        {
+            for (const auto &[id, subscriber] : subscribers_)
+            {
+                subscriber(delta_);
+            }
+        }
+        return delta_;
+    }
+
+private:
+    void enter(const ObjectHandle handle)
+    {
+        if (handle.index >= position_of_index_.size()) position_of_index_.resize(handle.index + 1, UINT32_MAX);
+
+        position_of_index_[handle.index] = static_cast<uint32_t>(members_.size());
+        members_.push_back(handle);
+        delta_.entered.push_back(handle);
+    }
+
+    void leave(const ObjectHandle handle)
+    {
+        const uint32_t position = position_of_index_[handle.index];
+        members_[position] = members_.back();
+        position_of_index_[members_[position].index] = position;
+        members_.pop_back();
+        position_of_index_[handle.index] = UINT32_MAX;
+        delta_.left.push_back(handle);
+    }
+};
+
+// flat binary encoding in host byte order: scalars as-is, strings as a
+// uint32 length followed by the bytes
+template <typename T>
+void write_binary(std::string &out, const T &value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only scalars are written raw");
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+inline void write_binary(std::string &out, const std::string &value)
+{
+    write_binary(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+template <typename T>
+bool read_binary(const char *&cursor, const char *end, T &value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only scalars are read raw");
+    if (static_cast<size_t>(end - cursor) < sizeof(T)) return false;
+
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+inline bool read_binary(const char *&cursor, const char *end, std::string &value)
+{
+    uint32_t size = 0;
+    if (!read_binary(cursor, end, size) || static_cast<size_t>(end - cursor) < size) return false;
+
+    value.assign(cursor, size);
+    cursor += size;
+    return true;
+}
+
+// compile-time type tables emitted by reflektc; StaticTypeInfo<T> is
+// specialized per generated struct with:
+//   type_name, base_type_name, attributes and arguments (type-level),
+//   properties (own, declaration order), slot_count (including bases),
+//   get/set by slot, serialize/deserialize
+struct StaticPropertyInfo
+{
+    const char *name;
+    const char *type_name;
+    ValueKind kind;
+    uint32_t attributes = PropertyAttributes::None;
+    AttributeArguments arguments = {};
+};
+
+template <typename T>
+struct StaticTypeInfo;
+
+// registers a generated type so it is reflectable like any DSL type; the
+// defaults come from the struct's member initializers. False if the name or
+// one of its property hashes collides with an already registered type.
+template <typename T>
+bool register_static_type()
+{
+    using Info = StaticTypeInfo<T>;
+
+    auto type = std::make_unique<TypeDescriptor>(Info::type_name);
+    if (*Info::base_type_name)
+    {
+        type->set_base_type(Info::base_type_name);
+    }
+    type->attributes = Info::attributes;
+    type->arguments = Info::arguments;
+
+    const T defaults{};
+    const size_t first_slot = Info::slot_count - Info::properties.size();
+    for (size_t i = 0; i < Info::properties.size(); ++i)
+    {
+        const auto &info = Info::properties[i];
+        type->add_property(info.name, info.type_name, Info::get(defaults, first_slot + i), info.attributes);
+        type->properties.back().arguments = info.arguments;
+    }
+
+    return TypeRegistry::instance().register_type(std::move(type));
+}
+
+template <typename T>
+[[nodiscard]] bool store_matches(const ObjectStore &store)
+{
+    return store.get_type_name() == StaticTypeInfo<T>::type_name && store.slot_count() == StaticTypeInfo<T>::slot_count;
+}
+
+template <typename T>
+ObjectHandle store_insert(ObjectStore &store, const T &object)
+{
+    if (!store_matches<T>(store)) return {};
+
+    const auto handle = store.create();
+    const size_t row = *store.row_of(handle);
+    for (size_t slot = 0; slot < StaticTypeInfo<T>::slot_count; ++slot)
+    {
+        store.set_value(row, slot, StaticTypeInfo<T>::get(object, slot));
+    }
+
+    return handle;
+}
+
+template <typename T>
+[[nodiscard]] std::optional<T> store_load(const ObjectStore &store, const ObjectHandle handle)
+{
+    const auto row = store.row_of(handle);
+    if (!row || !store_matches<T>(store)) return std::nullopt;
+
+    T object{};
+    for (size_t slot = 0; slot < StaticTypeInfo<T>::slot_count; ++slot)
+    {
+        StaticTypeInfo<T>::set(object, slot, store.get_value(*row, slot));
+    }
+
+    return object;
+}
+
+template <typename T>
+[[nodiscard]] std::unique_ptr<DynamicObject> to_dynamic(const T &object)
+{
+    auto dynamic = ObjectFactory::create(StaticTypeInfo<T>::type_name);
+    if (!dynamic) return nullptr;
+
+    const auto layout = TypeRegistry::instance().get_all_properties(StaticTypeInfo<T>::type_name);
+    for (size_t slot = 0; slot < layout.size() && slot < StaticTypeInfo<T>::slot_count; ++slot)
+    {
+        dynamic->set_property(layout[slot].name, StaticTypeInfo<T>::get(object, slot));
+    }
+
+    return dynamic;
+}
+
+class PropertyFileParser
+{
+public:
+    static std::unique_ptr<TypeDescriptor> parse_simple_format(const std::string &content)
+    {
+        auto lines = split_lines(content);
+        if (lines.empty()) return nullptr;
+
+        AttributeArguments type_arguments;
+        const uint32_t type_attributes = strip_attributes(lines[0], &type_arguments);
+        auto type_line = split(lines[0], ':');
+        if (type_line.empty()) return nullptr;
+
+        auto type_desc = std::make_unique<TypeDescriptor>(trim(type_line[0]));
+        type_desc->attributes = type_attributes;
+        type_desc->arguments = type_arguments;
+
+        if (type_line.size() > 1)
+        {
+            type_desc->set_base_type(trim(type_line[1]));
+        }
+
+        for (size_t i = 1; i < lines.size(); ++i)
+        {
+            AttributeArguments arguments;
+            const uint32_t attributes = strip_attributes(lines[i], &arguments);
+            if (auto prop_parts = split(lines[i], ':'); prop_parts.size() >= 2)
+            {
+                std::string prop_name = trim(prop_parts[0]);
+
+                auto type_default = split(prop_parts[1], '=');
+                std::string prop_type = trim(type_default[0]);
+
+                PropertyValue default_val;
+                if (!reference_target(prop_type).empty())
+                {
+                    default_val = ObjectHandle();
+                }
+                if (type_default.size() > 1)
+                {
+                    std::string default_str = trim(type_default[1]);
+                    default_val = parse_default_value(prop_type, default_str);
+                }
+
+                type_desc->add_property(prop_name, prop_type, default_val, attributes);
+                type_desc->properties.back().arguments = arguments;
+            }
+        }
+
+        return type_desc;
+    }
+
+    // removes trailing @attribute tokens from a declaration line and returns
+    // their flags: "hp: int = 100 @replicated @persistent". Only known names
+    // are taken, so a string default like "@home" stays intact.
+    // Parameterized ones such as @history(8) go to `arguments` when given.
+    static uint32_t strip_attributes(std::string &line, AttributeArguments *arguments = nullptr)
+    {
+        uint32_t attributes = PropertyAttributes::None;
+        while (true)
+        {
+            const size_t end = line.find_last_not_of(" \t\r");
+            if (end == std::string::npos) break;
+
+            // "@name(args)" may hold blanks inside the parentheses
+            const size_t open = line[end] == ')' ? line.rfind('(', end) : std::string::npos;
+            const size_t name_end = open != std::string::npos ? open : end + 1;
+            if (name_end == 0) break;
+            const size_t begin = line.find_last_of(" \t", name_end - 1);
+            const size_t token = begin == std::string::npos ? 0 : begin + 1;
+            if (line[token] != '@' || token == 0) break;
+
+            const auto name = std::string_view(line).substr(token + 1, name_end - token - 1);
+            if (open != std::string::npos)
+            {
+                const auto args = std::string_view(line).substr(open + 1, end - open - 1);
+                if (!parse_attribute_arguments(name, args, arguments)) break;
+            }
+            else
+            {
+                const auto flag = PropertyAttributes::from_name(name);
+                if (flag == PropertyAttributes::None) break;
+                attributes |= flag;
+            }
+
+            line.erase(token);
+        }
+        return attributes;
+    }
+
+    // schema files may hold several types, one block each, separated by
+    // blank lines; func(begin, end) gets the byte range of every block
+    template <typename Func>
+    static void for_each_block(const std::string &content, Func &&func)
+    {
+        size_t block_start = std::string::npos;
+        size_t pos = 0;
+        while (pos <= content.size())
+        {
+            size_t line_end = content.find('\n', pos);
+            if (line_end == std::string::npos) line_end = content.size();
+
+            const bool blank = content.find_first_not_of(" \t\r", pos) >= line_end;
+            if (!blank && block_start == std::string::npos)
+            {
+                block_start = pos;
+            }
+            if ((blank || line_end == content.size()) && block_start != std::string::npos)
+            {
+                func(block_start, line_end);
+                block_start = std::string::npos;
+            }
+
+            pos = line_end + 1;
+        }
+    }
+
+    static std::vector<std::unique_ptr<TypeDescriptor>> parse_blocks(const std::string &content)
+    {
+        std::vector<std::unique_ptr<TypeDescriptor>> types;
+        for_each_block(content,
+                       [&](const size_t begin, const size_t end)
+                       {
+                           if (auto type = parse_simple_format(content.substr(begin, end - begin)))
+                           {
+                               types.push_back(std::move(type));
+                           }
+                       });
+        return types;
+    }
+
+private:
+    // false for unknown names or malformed arguments, which leaves the token in the line
+    static bool parse_attribute_arguments(const std::string_view name, std::string_view args,
+                                          AttributeArguments *arguments)
+    {
+        const size_t first = args.find_first_not_of(" \t");
+        const size_t last = args.find_last_not_of(" \t");
+        args = first == std::string_view::npos ? std::string_view() : args.substr(first, last - first + 1);
+
+        if (name == "history")
+        {
+            uint32_t depth = 0;
+            const auto [ptr, ec] = std::from_chars(args.data(), args.data() + args.size(), depth);
+            if (ec != std::errc() || ptr != args.data() + args.size() || depth == 0) return false;
+
+            if (arguments) arguments->history_depth = depth;
+            return true;
+        }
+        if (name == "range")
+        {
+            const size_t comma = args.find(',');
+            if (comma == std::string_view::npos) return false;
+
+            double bounds[2] = {};
+            const std::string_view parts[2] = {args.substr(0, comma), args.substr(comma + 1)};
+            for (size_t i = 0; i < 2; ++i)
+            {
+                const size_t begin = parts[i].find_first_not_of(" \t");
+                const size_t end = parts[i].find_last_not_of(" \t");
+                if (begin == std::string_view::npos) return false;
+
+                const char *last = parts[i].data() + end + 1;
+                const auto [ptr, ec] = std::from_chars(parts[i].data() + begin, last, bounds[i]);
+                if (ec != std::errc() || ptr != last) return false;
+            }
+            if (!(bounds[0] <= bounds[1])) return false;
+
+            if (arguments)
+            {
+                arguments->has_range = true;
+                arguments->range_min = bounds[0];
+                arguments->range_max = bounds[1];
+            }
+            return true;
+        }
+        return false;
+    }
+
+    static std::vector<std::string> split_lines(const std::string &str)
+    {
+        std::vector<std::string> lines;
+        std::istringstream iss(str);
+        std::string line;
+        while (std::getline(iss, line))
+        {
+            if (!line.empty())
+            {
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+
+    static std::vector<std::string> split(const std::string &str, const char delimiter)
+    {
+        std::vector<std::string> tokens;
+        std::istringstream iss(str);
+        std::string token;
+        while (std::getline(iss, token, delimiter))
+        {
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    static std::string trim(const std::string &str)
+    {
+        const size_t start = str.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        const size_t end = str.find_last_not_of(" \t\r\n");
+        return str.substr(start, end - start + 1);
+    }
+
+    static PropertyValue parse_default_value(const std::string &type, const std::string &value)
+    {
+        if (type == "int")
+        {
+            return std::stoi(value);
+        }
+        else if (type == "double")
+        {
+            return std::stod(value);
+        }
+        else if (type == "bool")
+        {
+            return value == "true" || value == "1";
+        }
+        else if (!reference_target(type).empty())
+        {
+            // references can only be bound at runtime; any default is null
+            return ObjectHandle();
+        }
+        else
+        {
+            return value;
+        }
+    }
+};
+
+// index over schema files that hold several types each, one block per type
+// separated by blank lines. Attaching streams every file once, line by line,
+// and keeps only the name and byte range of each block; the block itself is
+// parsed the first time the registry misses on that type name (or key).
+class SchemaLibrary
+{
+public:
+    struct Entry
+    {
+        std::string path;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    using Index = std::unordered_map<uint64_t, Entry, KeyHash>;
+
+    // the first file to declare a name wins; nullopt if a file cannot be read
+    [[nodiscard]] static std::optional<Index> build_index(const std::vector<std::string> &paths)
+    {
+        Index index;
+        for (const auto &path : paths)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file || !index_blocks(path, file, index)) return std::nullopt;
+        }
+
+        return index;
+    }
+
+    // installs the index as the registry's type loader; returns the number
+    // of types it can provide
+    static std::optional<size_t> attach(const std::vector<std::string> &paths)
+    {
+        auto index = build_index(paths);
+        if (!index) return std::nullopt;
+
+        const size_t count = index->size();
+        TypeRegistry::instance().set_type_loader(
+            [index = std::make_shared<const Index>(std::move(*index))](const uint64_t key)
+            {
+                const auto it = index->find(key);
+                return it != index->end() ? load_block(it->second) : nullptr;
+            });
+        return count;
+    }
+
+    [[nodiscard]] static std::unique_ptr<TypeDescriptor> load_block(const Entry &entry)
+    {
+        std::ifstream file(entry.path, std::ios::binary);
+        if (!file) return nullptr;
+
+        std::string block(entry.size, '\0');
+        file.seekg(static_cast<std::streamoff>(entry.offset));
+        if (!file.read(block.data(), static_cast<std::streamsize>(block.size()))) return nullptr;
+
+        // malformed numeric defaults throw from std::stoi/std::stod
+        try
+        {
+            return PropertyFileParser::parse_simple_format(block);
+        }
+        catch (const std::logic_error &)
+        {
+            return nullptr;
+        }
+    }
+
+private:
+    // the same block ranges PropertyFileParser::for_each_block finds, without
+    // holding the file in memory; false on a read error
+    static bool index_blocks(const std::string &path, std::istream &file, Index &index)
+    {
+        constexpr uint64_t no_block = UINT64_MAX;
+        uint64_t block_start = no_block;
+        uint64_t pos = 0;
+        std::string line;
+        std::string header;
+        while (std::getline(file, line))
+        {
+            const uint64_t line_end = pos + line.size();
+            const bool blank = line.find_first_not_of(" \t\r") == std::string::npos;
+            if (!blank && block_start == no_block)
+            {
+                block_start = pos;
+                header = line;
+            }
+            // eof here means the last line had no newline
+            if ((blank || file.eof()) && block_start != no_block)
+            {
+                add_block(path, header, block_start, line_end, index);
+                block_start = no_block;
+            }
+
+            pos = line_end + 1;
+        }
+        if (file.bad()) return false;
+
+        if (block_start != no_block) add_block(path, header, block_start, pos, index);
+        return true;
+    }
+
+    // the type name is the header line up to the optional ": Base" and
+    // trailing @attributes
+    static void add_block(const std::string &path, std::string header, const uint64_t begin, const uint64_t end,
+                          Index &index)
+    {
+        PropertyFileParser::strip_attributes(header);
+
+        const size_t name_end = std::min(header.find(':'), header.size());
+        const size_t first = header.find_first_not_of(" \t\r");
+        const size_t last = header.find_last_not_of(" \t\r", name_end ? name_end - 1 : 0);
+        if (first >= name_end || last == std::string::npos || last < first) return;
+
+        index.try_emplace(hash_name(header.substr(first, last - first + 1)), Entry{path, begin, end - begin});
+    }
+};
+
+inline std::string property_value_to_string(const PropertyValue &value)
+{
+    return std::visit(
+        [](const auto &v) -> std::string
+        {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                return "\"" + v + "\"";
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                return v ? "true" : "false";
+            }
+            else if constexpr (std::is_same_v<T, ObjectHandle>)
+            {
+                return v.is_valid() ? "ref(" + std::to_string(v.index) + ":" + std::to_string(v.generation) + ")"
+                                    : "null";
+            }
+            else
+            {
+                return std::to_string(v);
+            }
+        },
+        value);
+}
+
+inline void print_type_info(const std::string &type_name)
+{
+    auto *type_desc = TypeRegistry::instance().get_type(type_name);
+    if (!type_desc)
+    {
+        std::cout << "Type '" << type_name << "' not found!\n";
+        return;
+    }
+
+    std::cout << "type_name: " << type_desc->type_name << "\n";
+    std::cout << "base: " << (type_desc->base_type_name.empty() ? "none" : type_desc->base_type_name) << "\n";
+    std::cout << "properties:\n";
+
+    const auto all_props = TypeRegistry::instance().get_all_properties(type_name);
+
+    for (const auto &prop : all_props)
+    {
+        std::cout << "  - " << prop.name << ":\n";
+        std::cout << "    type: " << prop.type_name << "\n";
+        std::cout << "    default_value: " << property_value_to_string(prop.default_value) << "\n";
+        std::cout << "    inherited: " << (prop.is_inherited ? "true" : "false") << "\n";
+        if (prop.attributes)
+        {
+            std::cout << "    attributes: " << PropertyAttributes::to_string(prop.attributes) << "\n";
+        }
+        if (prop.arguments.history_depth)
+        {
+            std::cout << "    history: " << prop.arguments.history_depth << " ticks\n";
+        }
+        if (prop.arguments.has_range)
+        {
+            std::cout << "    range: [" << prop.arguments.range_min << ", " << prop.arguments.range_max << "]\n";
+        }
+    }
+
+    if (const auto methods = MethodTable::compile(type_name); methods && methods->size())
+    {
+        std::cout << "methods:\n";
+        for (MethodId id = 0; id < methods->size(); ++id)
+        {
+            const auto &method = methods->get_method(id);
+            std::cout << "  - " << method.name << "(";
+            for (size_t i = 0; i < method.parameter_types.size(); ++i)
+            {
+                std::cout << (i ? ", " : "") << method.parameter_types[i];
+            }
+            std::cout << ") -> " << method.return_type << "\n";
+        }
+    }
+
+    std::cout << "\n";
+}
+
+inline void print_object_info(const DynamicObject &obj)
+{
+    std::cout << "object_type: " << obj.get_type_name() << "\n";
+    std::cout << "properties:\n";
+
+    const auto prop_names = obj.get_property_names();
+    for (const auto &name : prop_names)
+    {
+        auto value = obj.get_property_variant(name);
+        std::cout << "  - " << name << ":\n";
+        std::cout << "    value: " << property_value_to_string(value) << "\n";
+
+        std::string actual_type = std::visit(
+            [](const auto &v) -> std::string
+            {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, int>)
+                    return "int";
+                else if constexpr (std::is_same_v<T, double>)
+                    return "double";
+                else if constexpr (std::is_same_v<T, std::string>)
+                    return "string";
+                else if constexpr (std::is_same_v<T, bool>)
+                    return "bool";
+                else if constexpr (std::is_same_v<T, ObjectHandle>)
+                    return "ref";
+                else
+                    return "unknown";
+            },
+            value);
+
+        std::cout << "    runtime_type: " << actual_type << "\n";
+    }
+
+    std::cout << "\n";
+}
+
+enum class FormatStyle
+{
+    Yaml, // the print_object_info layout
+    Json, // one object per row, a store as an array
+    Csv,  // header line of slot names, one line per row
+};
+
+// output for one type compiled once: a literal fragment before every slot
+// plus a closing fragment, so formatting an object is appends only. Names,
+// quoting and declared types are resolved at compile time, not per object.
+class ObjectFormatter
+{
+private:
+    struct Step
+    {
+        std::string literal; // everything between the previous value and this one
+        size_t slot;
+        PropertyKey key;
+    };
+
+    std::string type_name_;
+    FormatStyle style_ = FormatStyle::Yaml;
+    std::vector<Step> steps_;
+    std::string closing_;
+    std::string document_open_;
+    std::string row_separator_;
+    std::string document_close_;
+
+    ObjectFormatter() = default;
+
+public:
+    // nullopt if the type is not registered. `required`/`excluded` pick the
+    // slots by attribute, e.g. (None, EditorOnly) for a shipping dump.
+    [[nodiscard]] static std::optional<ObjectFormatter>
+    compile(const std::string &type_name, const FormatStyle style, const uint32_t required = PropertyAttributes::None,
+            const uint32_t excluded = PropertyAttributes::None)
+    {
+        if (!TypeRegistry::instance().get_type(type_name)) return std::nullopt;
+
+        ObjectFormatter formatter;
+        formatter.type_name_ = type_name;
+        formatter.style_ = style;
+
+        const auto layout = TypeRegistry::instance().get_all_properties(type_name);
+        const auto slots = select_slots(layout, required, excluded);
+        std::string pending;
+        switch (style)
+        {
+        case FormatStyle::Yaml:
+            pending = "object_type: " + type_name + "\nproperties:\n";
+            for (const size_t slot : slots)
+            {
+                const auto &prop = layout[slot];
+                formatter.add_step(pending + "  - " + prop.name + ":\n    value: ", slot, prop);
+                pending = "\n    runtime_type: " + kind_name(value_kind_for(prop)) + "\n";
+            }
+            formatter.closing_ = pending + "\n";
+            break;
+        case FormatStyle::Json:
+            pending = "{";
+            for (const size_t slot : slots)
+            {
+                std::string key;
+                append_json_string(key, layout[slot].name);
+                formatter.add_step(pending + key + ":", slot, layout[slot]);
+                pending = ",";
+            }
+            formatter.closing_ = "}";
+            formatter.document_open_ = "[";
+            formatter.row_separator_ = ",\n";
+            formatter.document_close_ = "]\n";
+            break;
+        case FormatStyle::Csv:
+            for (const size_t slot : slots)
+            {
+                formatter.add_step(pending, slot, layout[slot]);
+                append_csv_field(formatter.document_open_, layout[slot].name);
+                formatter.document_open_ += ",";
+                pending = ",";
+            }
+            if (!slots.empty()) formatter.document_open_.back() = '\n';
+            formatter.closing_ = "\n";
+            break;
+        }
+
+        return formatter;
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+    [[nodiscard]] FormatStyle get_style() const { return style_; }
+
+    // one row; the store must hold this formatter's type
+    void append(const ObjectStore &store, const size_t row, std::string &out) const
+    {
+        for (const auto &step : steps_)
+        {
+            out += step.literal;
+            std::visit([&](const auto &values) { append_value(values[row], out); }, store.get_column(step.slot));
+        }
+        out += closing_;
+    }
+
+    void append(const DynamicObject &object, std::string &out) const
+    {
+        for (const auto &step : steps_)
+        {
+            out += step.literal;
+            if (const auto value = object.find_property(step.key))
+            {
+                std::visit([&](const auto &v) { append_value(v, out); }, *value);
+            }
+            else
+            {
+                append_null(out);
+            }
+        }
+        out += closing_;
+    }
+
+    // the whole store as one document (JSON array, CSV with header)
+    bool append_all(const ObjectStore &store, std::string &out) const
+    {
+        if (store.get_type_name() != type_name_) return false;
+
+        out += document_open_;
+        for (size_t row = 0; row < store.size(); ++row)
+        {
+            if (row > 0) out += row_separator_;
+            append(store, row, out);
+        }
+        out += document_close_;
+        return true;
+    }
+
+    [[nodiscard]] std::string format(const DynamicObject &object) const
+    {
+        std::string out;
+        append(object, out);
+        return out;
+    }
+
+    static std::string kind_name(const ValueKind kind)
+    {
+        switch (kind)
+        {
+        case ValueKind::Int:
+            return "int";
+        case ValueKind::Double:
+            return "double";
+        case ValueKind::String:
+            return "string";
+        case ValueKind::Bool:
+            return "bool";
+        case ValueKind::Ref:
+            return "ref";
+        }
+        return "unknown";
+    }
+
+    static void append_json_string(std::string &out, const std::string_view value)
+    {
+        out += '"';
+        for (const char c : value)
+        {
+            switch (c)
+            {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    constexpr char hex[] = "0123456789abcdef";
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xf];
+                    out += hex[c & 0xf];
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    // RFC 4180: quoted only when needed, quotes doubled. An empty value is
+    // written as "" so that import can tell it from a missing cell.
+    static void append_csv_field(std::string &out, const std::string_view value)
+    {
+        if (!value.empty() && value.find_first_of(",\"\r\n") == std::string_view::npos)
+        {
+            out.append(value.data(), value.size());
+            return;
+        }
+
+        out += '"';
+        for (const char c : value)
+        {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+private:
+    void add_step(std::string literal, const size_t slot, const PropertyDescriptor &prop)
+    {
+        steps_.push_back({std::move(literal), slot, PropertyKey(prop.name)});
+    }
+
+    template <typename T>
+    void append_value(const T &value, std::string &out) const
+    {
+        if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, uint8_t>)
+        {
+            out += value ? "true" : "false";
+        }
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            // JSON has no NaN or infinity, so they become null; YAML spells
+            // them .nan/.inf, and CSV keeps to_chars' nan/inf, which import
+            // reads back
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (!std::isfinite(value) && style_ != FormatStyle::Csv)
+                {
+                    if (style_ == FormatStyle::Json)
+                    {
+                        out += "null";
+                    }
+                    else
+                    {
+                        out += std::isnan(value) ? ".nan" : value < 0 ? "-.inf" : ".inf";
+                    }
+                    return;
+                }
+            }
+
+            // shortest form that reads back to the same value
+            char buffer[32];
+            const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            if (style_ == FormatStyle::Csv)
+            {
+                append_csv_field(out, value);
+            }
+            else
+            {
+                append_json_string(out, value);
+            }
+        }
+        else
+        {
+            append_handle(value, out);
+        }
+    }
+
+    void append_handle(const ObjectHandle value, std::string &out) const
+    {
+        if (!value.is_valid())
+        {
+            // a quoted "" in CSV, so a null ref stays distinct from a
+            // missing cell, which takes the slot default on import
+            if (style_ == FormatStyle::Csv)
+            {
+                out += "\"\"";
+            }
+            else
+            {
+                append_null(out);
+            }
+            return;
+        }
+
+        const auto index = std::to_string(value.index);
+        const auto generation = std::to_string(value.generation);
+        switch (style_)
+        {
+        case FormatStyle::Yaml:
+            out += "ref(" + index + ":" + generation + ")";
+            break;
+        case FormatStyle::Json:
+            out += "[" + index + "," + generation + "]";
+            break;
+        case FormatStyle::Csv:
+            out += index + ":" + generation;
+            break;
+        }
+    }
+
+    // CSV leaves a missing value as an empty, unquoted cell
+    void append_null(std::string &out) const
+    {
+        if (style_ != FormatStyle::Csv) out += "null";
+    }
+};
+
+struct CsvImportResult
+{
+    bool ok = false;
+    size_t rows = 0;
+    size_t error_offset = 0; // byte offset of the first record that failed to parse
+};
+
+// CSV round-trip for one store, in the ObjectFormatter CSV dialect: a
+// header of slot names, RFC 4180 quoting, true/false, refs as
+// index:generation ("" for null). Empty strings are written as "".
+class StoreCsv
+{
+public:
+    // rows per formatted block; each block is split across threads and
+    // written out before the next one is formatted
+    static constexpr size_t export_block_rows = 1 << 18;
+    static constexpr size_t import_min_chunk_bytes = 1 << 20;
+
+    static bool export_csv(const ObjectStore &store, std::ostream &sink)
+    {
+        const auto formatter = ObjectFormatter::compile(store.get_type_name(), FormatStyle::Csv);
+        if (!formatter) return false;
+
+        std::string header;
+        for (const auto &prop : store.get_layout())
+        {
+            if (!header.empty()) header += ',';
+            ObjectFormatter::append_csv_field(header, prop.name);
+        }
+        sink << header << '\n';
+
+        for (size_t block = 0; block < store.size(); block += export_block_rows)
+        {
+            const size_t rows = std::min(export_block_rows, store.size() - block);
+            const size_t chunks = parallel_chunk_count(rows);
+            std::vector<std::string> parts(chunks);
+            parallel_for_chunks(rows, chunks,
+                                [&](const size_t chunk, const size_t begin, const size_t end)
+                                {
+                                    for (size_t row = block + begin; row < block + end; ++row)
+                                    {
+                                        formatter->append(store, row, parts[chunk]);
+                                    }
+                                });
+
+            for (const auto &part : parts)
+            {
+                sink.write(part.data(), static_cast<std::streamsize>(part.size()));
+            }
+        }
+
+        return static_cast<bool>(sink);
+    }
+
+    // header columns are matched to slots by name once; unknown columns are
+    // ignored and missing columns or empty unquoted cells take the slot
+    // default, while a quoted "" is an empty string (or a null ref).
+    // All or nothing: on a parse error no rows are added.
+    static CsvImportResult import_csv(ObjectStore &store, const std::string_view source)
+    {
+        CsvImportResult result;
+
+        size_t body = 0;
+        std::vector<std::string> header;
+        if (!parse_record(source, body, header))
+        {
+            result.ok = source.empty();
+            return result;
+        }
+
+        // header position -> slot; repeats of a column are ignored
+        constexpr size_t ignored = SIZE_MAX;
+        std::vector<size_t> slot_of_field(header.size(), ignored);
+        std::vector<bool> taken(store.slot_count(), false);
+        for (size_t field = 0; field < header.size(); ++field)
+        {
+            if (const auto slot = store.find_slot(header[field]); slot && !taken[*slot])
+            {
+                slot_of_field[field] = *slot;
+                taken[*slot] = true;
+            }
+        }
+
+        const auto starts = split_records(source, body);
+        const size_t chunks = starts.size() - 1;
+        std::vector<std::vector<Column>> parts(chunks);
+        std::vector<size_t> failures(chunks, ignored);
+        parallel_for_chunks(chunks, chunks,
+                            [&](const size_t chunk, size_t, size_t)
+                            {
+                                failures[chunk] = parse_chunk(store, source, starts[chunk], starts[chunk + 1],
+                                                              slot_of_field, parts[chunk]);
+                            });
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            if (failures[chunk] != ignored)
+            {
+                result.error_offset = failures[chunk];
+                return result;
+            }
+        }
+
+        for (auto &part : parts)
+        {
+            result.rows += part.empty() ? 0 : std::visit([](const auto &values) { return values.size(); }, part[0]);
+            store.append_columns(std::move(part));
+        }
+
+        result.ok = true;
+        return result;
+    }
+
+    static CsvImportResult import_csv(ObjectStore &store, std::istream &source)
+    {
+        std::ostringstream buffer;
+        buffer << source.rdbuf();
+        return import_csv(store, buffer.str());
+    }
+
+private:
+    // record start offsets cutting the body into roughly equal byte ranges.
+    // Quoted fields may hold newlines, so quote parity is tracked up to each
+    // cut, jumping from quote to quote with memchr.
+    static std::vector<size_t> split_records(const std::string_view source, const size_t body)
+    {
+        const size_t workers = std::max(1u, std::thread::hardware_concurrency());
+        const size_t chunks = std::max<size_t>(1, std::min(workers, (source.size() - body) / import_min_chunk_bytes));
+        const size_t chunk_bytes = (source.size() - body) / chunks + 1;
+
+        std::vector<size_t> starts{body};
+        const char *data = source.data();
+        size_t pos = body;
+        bool quoted = false;
+        while (starts.size() < chunks)
+        {
+            const size_t target = starts.back() + chunk_bytes;
+            if (target >= source.size()) break;
+
+            for (size_t end = std::max(pos, target); pos < end;)
+            {
+                const auto quote = static_cast<const char *>(std::memchr(data + pos, '"', end - pos));
+                if (!quote)
+                {
+                    pos = end;
+                    break;
+                }
+                pos = static_cast<size_t>(quote - data) + 1;
+                quoted = !quoted;
+            }
+
+            size_t boundary = source.size();
+            while (pos < source.size())
+            {
+                const auto quote = static_cast<const char *>(std::memchr(data + pos, '"', source.size() - pos));
+                if (quoted)
+                {
+                    if (!quote) break;
+                    pos = static_cast<size_t>(quote - data) + 1;
+                    quoted = false;
+                    continue;
+                }
+
+                const auto newline = static_cast<const char *>(std::memchr(data + pos, '\n', source.size() - pos));
+                if (newline && (!quote || newline < quote))
+                {
+                    boundary = static_cast<size_t>(newline - data) + 1;
+                    pos = boundary;
+                    break;
+                }
+                if (!quote) break;
+
+                pos = static_cast<size_t>(quote - data) + 1;
+                quoted = true;
+            }
+
+            if (boundary >= source.size()) break;
+            starts.push_back(boundary);
+        }
+
+        starts.push_back(source.size());
+        return starts;
+    }
+
+    // the header record, copied out of the source
+    static bool parse_record(const std::string_view source, size_t &pos, std::vector<std::string> &fields)
+    {
+        if (pos >= source.size()) return false;
+
+        std::vector<std::string_view> views;
+        std::vector<uint8_t> quoted;
+        std::string scratch;
+        if (!scan_record(source, pos, views, quoted, scratch)) return false;
+
+        fields.assign(views.begin(), views.end());
+        return true;
+    }
+
+    // one record starting at `pos`, which ends up at the next record. Plain
+    // fields are views into the source; quoted fields are unescaped into
+    // `scratch` and flagged in `quoted`. False on an unterminated or
+    // malformed quoted field.
+    static bool scan_record(const std::string_view source, size_t &pos, std::vector<std::string_view> &views,
+                            std::vector<uint8_t> &quoted, std::string &scratch)
+    {
+        views.clear();
+        quoted.clear();
+        scratch.clear();
+        std::vector<std::pair<size_t, size_t>> unescaped; // field -> range in scratch
+
+        const char *data = source.data();
+        const size_t size = source.size();
+        while (true)
+        {
+            if (pos < size && data[pos] == '"')
+            {
+                const size_t start = scratch.size();
+                ++pos;
+                while (true)
+                {
+                    const auto quote = static_cast<const char *>(std::memchr(data + pos, '"', size - pos));
+                    if (!quote) return false; // unterminated quote
+
+                    const size_t at = static_cast<size_t>(quote - data);
+                    scratch.append(data + pos, at - pos);
+                    pos = at + 1;
+                    if (pos < size && data[pos] == '"')
+                    {
+                        scratch += '"';
+                        ++pos;
+                        continue;
+                    }
+                    break;
+                }
+                unescaped.emplace_back(views.size(), start);
+                views.emplace_back(); // patched below once scratch stops growing
+                quoted.push_back(1);
+                if (pos < size && data[pos] == '\r') ++pos;
+                if (pos < size && data[pos] != ',' && data[pos] != '\n') return false;
+            }
+            else
+            {
+                size_t end = pos;
+                while (end < size && data[end] != ',' && data[end] != '\n')
+                {
+                    ++end;
+                }
+
+                size_t field_end = end;
+                if (field_end > pos && data[field_end - 1] == '\r') --field_end;
+                views.emplace_back(data + pos, field_end - pos);
+                quoted.push_back(0);
+                pos = end;
+            }
+
+            if (pos >= size || data[pos] == '\n')
+            {
+                if (pos < size) ++pos;
+                break;
+            }
+            ++pos; // ','
+        }
+
+        for (size_t i = 0; i < unescaped.size(); ++i)
+        {
+            const size_t begin = unescaped[i].second;
+            const size_t end = i + 1 < unescaped.size() ? unescaped[i + 1].second : scratch.size();
+            views[unescaped[i].first] = std::string_view(scratch).substr(begin, end - begin);
+        }
+        return true;
+    }
+
+    // parses [begin, end) into fresh columns; SIZE_MAX on success, else the
+    // offset of the failing record
+    static size_t parse_chunk(const ObjectStore &store, const std::string_view source, const size_t begin,
+                              const size_t end, const std::vector<size_t> &slot_of_field, std::vector<Column> &columns)
+    {
+        const auto &layout = store.get_layout();
+        for (const auto &prop : layout)
+        {
+            columns.push_back(make_column(value_kind_for(prop)));
+        }
+
+        const auto chunk = source.substr(0, end);
+        std::vector<std::string_view> fields;
+        std::vector<uint8_t> quoted;
+        std::string scratch;
+        size_t rows = 0;
+        for (size_t pos = begin; pos < end;)
+        {
+            const size_t record = pos;
+            if (!scan_record(chunk, pos, fields, quoted, scratch)) return record;
+
+            // blank lines carry no record; export never writes one, since
+            // empty strings and null refs go out as ""
+            if (fields.size() == 1 && fields[0].empty() && !quoted[0]) continue;
+
+            for (size_t field = 0; field < fields.size() && field < slot_of_field.size(); ++field)
+            {
+                const size_t slot = slot_of_field[field];
+                if (slot == SIZE_MAX || (fields[field].empty() && !quoted[field])) continue;
+                if (!parse_value(fields[field], columns[slot])) return record;
+            }
+
+            ++rows;
+            for (size_t slot = 0; slot < columns.size(); ++slot)
+            {
+                std::visit(
+                    [&](auto &values)
+                    {
+                        using Elem = typename std::decay_t<decltype(values)>::value_type;
+                        if (values.size() < rows) values.push_back(store.default_element<Elem>(slot));
+                    },
+                    columns[slot]);
+            }
+        }
+
+        return SIZE_MAX;
+    }
+
+    static bool parse_value(const std::string_view text, Column &column)
+    {
+        const char *first = text.data();
+        const char *last = text.data() + text.size();
+        return std::visit(
+            [&](auto &values)
+            {
+                using Elem = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (std::is_same_v<Elem, std::string>)
+                {
+                    values.emplace_back(text);
+                    return true;
+                }
+                else if constexpr (std::is_same_v<Elem, uint8_t>)
+                {
+                    const bool yes = text == "true" || text == "1";
+                    if (!yes && text != "false" && text != "0") return false;
+                    values.push_back(yes ? 1 : 0);
+                    return true;
+                }
+                else if constexpr (std::is_same_v<Elem, ObjectHandle>)
+                {
+                    ObjectHandle handle;
+                    if (text.empty())
+                    {
+                        values.push_back(handle);
+                        return true;
+                    }
+                    const auto index = std::from_chars(first, last, handle.index);
+                    if (index.ec != std::errc() || index.ptr == last || *index.ptr != ':') return false;
+                    const auto generation = std::from_chars(index.ptr + 1, last, handle.generation);
+                    if (generation.ec != std::errc() || generation.ptr != last) return false;
+                    values.push_back(handle);
+                    return true;
+                }
+                else
+                {
+                    Elem value{};
+                    const auto parsed = std::from_chars(first, last, value);
+                    if (parsed.ec != std::errc() || parsed.ptr != last) return false;
+                    values.push_back(value);
+                    return true;
+                }
+            },
+            column);
+    }
+};
+
+template <typename Func>
+void iterate_type_properties(const std::string &type_name, Func &&callback)
+{
+    const auto all_props = TypeRegistry::instance().get_all_properties(type_name);
+    for (const auto &prop : all_props)
+    {
+        callback(prop.name, prop.type_name, prop.default_value, prop.is_inherited);
+    }
+}
+
+template <typename Func>
+void iterate_object_properties(const DynamicObject &obj, Func &&callback)
+{
+    const auto prop_names = obj.get_property_names();
+    for (const auto &name : prop_names)
+    {
+        auto value = obj.get_property_variant(name);
+        callback(name, value);
+    }
+}
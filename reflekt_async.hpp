@@ -0,0 +1,604 @@
+#pragma once
+
+// Asynchronous bulk file loading for startup.
+//
+// AsyncFileReader reads many files at once. On Linux kernels that allow it,
+// reads are batched through an io_uring driven by raw syscalls (no liburing);
+// otherwise, or when io_uring_setup is refused, a small thread pool issues
+// plain pread calls. AsyncSchemaLoader builds a pipeline on top of it:
+// completed reads are handed to parse workers while further reads are still
+// in flight, and parsed types are registered on the calling thread as soon
+// as their base type is known, so I/O, parsing and registration overlap.
+//
+// POSIX only; io_uring only where <linux/io_uring.h> is available.
+
+#include "reflekt.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define REFLEKT_HAS_IO_URING 1
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// hand-off between pipeline stages; pop() blocks until an item arrives or
+// the queue is closed and drained
+template <typename T>
+class StageQueue
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<T> items_;
+    bool closed_ = false;
+
+public:
+    void push(T item)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            items_.push_back(std::move(item));
+        }
+        ready_.notify_one();
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    std::optional<T> pop()
+    {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return std::nullopt;
+
+        auto item = std::move(items_.front());
+        items_.pop_front();
+        return item;
+    }
+};
+
+enum class IoBackend
+{
+    Auto,
+    IoUring,
+    ThreadPool,
+};
+
+class AsyncFileReader
+{
+public:
+    // index into the path list, file content or nullopt if it could not be read
+    using Consumer = std::function<void(size_t, std::optional<std::string>)>;
+
+    // reads every file and hands it to on_file exactly once, in completion
+    // order. on_file may run on several threads at once. Returns the
+    // backend that did the work (never Auto).
+    static IoBackend read_all(const std::vector<std::string> &paths, const Consumer &on_file,
+                              const IoBackend backend = IoBackend::Auto, const unsigned queue_depth = 64)
+    {
+#ifdef REFLEKT_HAS_IO_URING
+        if (backend != IoBackend::ThreadPool && read_with_io_uring(paths, on_file, queue_depth))
+        {
+            return IoBackend::IoUring;
+        }
+#endif
+        read_with_thread_pool(paths, on_file);
+        return IoBackend::ThreadPool;
+    }
+
+    // whole-file pread loop; also the per-file fallback when io_uring
+    // rejects an individual read
+    static std::optional<std::string> read_file(const std::string &path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return std::nullopt;
+
+        auto content = read_fd(fd);
+        close(fd);
+        return content;
+    }
+
+private:
+    static std::optional<std::string> read_fd(const int fd)
+    {
+        struct stat info;
+        if (fstat(fd, &info) != 0) return std::nullopt;
+
+        std::string content(static_cast<size_t>(info.st_size), '\0');
+        size_t done = 0;
+        while (done < content.size())
+        {
+            const ssize_t got = pread(fd, content.data() + done, content.size() - done, static_cast<off_t>(done));
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) return std::nullopt;
+            if (got == 0) break; // file shrank underneath us
+
+            done += static_cast<size_t>(got);
+        }
+
+        content.resize(done);
+        return content;
+    }
+
+    static void read_with_thread_pool(const std::vector<std::string> &paths, const Consumer &on_file)
+    {
+        // reads block in the kernel, so use more threads than cores
+        const size_t threads =
+            std::min<size_t>(paths.size(), std::max(4u, 2 * std::thread::hardware_concurrency()));
+
+        std::atomic<size_t> next{0};
+        const auto work = [&]
+        {
+            for (size_t index = next++; index < paths.size(); index = next++)
+            {
+                on_file(index, read_file(paths[index]));
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads; ++i)
+        {
+            pool.emplace_back(work);
+        }
+        work();
+
+        for (auto &thread : pool)
+        {
+            thread.join();
+        }
+    }
+
+#ifdef REFLEKT_HAS_IO_URING
+    // minimal single-issuer ring: one submission queue, one completion
+    // queue, both mmap'ed from the ring fd
+    class Ring
+    {
+    private:
+        int fd_ = -1;
+        void *sq_ring_ = MAP_FAILED;
+        void *cq_ring_ = MAP_FAILED;
+        size_t sq_ring_size_ = 0;
+        size_t cq_ring_size_ = 0;
+        io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+        size_t sqes_size_ = 0;
+
+        unsigned *sq_head_ = nullptr;
+        unsigned *sq_tail_ = nullptr;
+        unsigned *sq_mask_ = nullptr;
+        unsigned *sq_array_ = nullptr;
+        unsigned *cq_head_ = nullptr;
+        unsigned *cq_tail_ = nullptr;
+        unsigned *cq_mask_ = nullptr;
+        io_uring_cqe *cqes_ = nullptr;
+        unsigned entries_ = 0;
+        unsigned to_submit_ = 0;
+
+        Ring() = default;
+
+    public:
+        Ring(const Ring &) = delete;
+        Ring &operator=(const Ring &) = delete;
+
+        ~Ring()
+        {
+            if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+            if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+            if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+            if (fd_ >= 0) close(fd_);
+        }
+
+        // nullptr when the kernel (or a seccomp policy) refuses io_uring
+        static std::unique_ptr<Ring> create(const unsigned entries)
+        {
+            std::unique_ptr<Ring> ring(new Ring());
+
+            io_uring_params params{};
+            ring->fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (ring->fd_ < 0) return nullptr;
+
+            ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap)
+            {
+                ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+            }
+
+            ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  ring->fd_, IORING_OFF_SQ_RING);
+            if (ring->sq_ring_ == MAP_FAILED) return nullptr;
+
+            ring->cq_ring_ = single_mmap ? ring->sq_ring_
+                                         : mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_CQ_RING);
+            if (ring->cq_ring_ == MAP_FAILED) return nullptr;
+
+            ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            ring->sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+                                                           MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_SQES));
+            if (ring->sqes_ == MAP_FAILED) return nullptr;
+
+            auto *sq = static_cast<char *>(ring->sq_ring_);
+            auto *cq = static_cast<char *>(ring->cq_ring_);
+            ring->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+            ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            ring->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            ring->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            ring->entries_ = params.sq_entries;
+            return ring;
+        }
+
+        [[nodiscard]] unsigned entries() const { return entries_; }
+
+        // queued reads the kernel has not been handed yet
+        [[nodiscard]] unsigned unsubmitted() const { return to_submit_; }
+
+        // queues a single-iovec read; false if the submission queue is full
+        bool queue_read(const int fd, const iovec *iov, const uint64_t offset, const uint64_t user_data)
+        {
+            const unsigned tail = *sq_tail_;
+            if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_) return false;
+
+            const unsigned index = tail & *sq_mask_;
+            io_uring_sqe &sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READV;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<uint64_t>(iov);
+            sqe.len = 1;
+            sqe.off = offset;
+            sqe.user_data = user_data;
+
+            sq_array_[index] = index;
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+            ++to_submit_;
+            return true;
+        }
+
+        // submits everything queued and waits for at least `wait` completions
+        bool submit_and_wait(const unsigned wait)
+        {
+            while (true)
+            {
+                const long result =
+                    syscall(__NR_io_uring_enter, fd_, to_submit_, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (result >= 0)
+                {
+                    to_submit_ -= static_cast<unsigned>(result);
+                    return true;
+                }
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+            }
+        }
+
+        template <typename Func>
+        void drain(Func &&func)
+        {
+            unsigned head = *cq_head_;
+            const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
+            {
+                const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+                func(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+    };
+
+    // false only if the ring could not be set up; per-file read errors fall
+    // back to pread for that file
+    static bool read_with_io_uring(const std::vector<std::string> &paths, const Consumer &on_file,
+                                   const unsigned queue_depth)
+    {
+        auto ring = Ring::create(std::max(1u, queue_depth));
+        if (!ring) return false;
+
+        struct Read
+        {
+            int fd = -1;
+            std::string content;
+            size_t done = 0;
+            iovec iov{};
+        };
+        std::vector<Read> reads(paths.size());
+
+        const auto finish = [&](const size_t index, std::optional<std::string> content)
+        {
+            if (reads[index].fd >= 0) close(reads[index].fd);
+            reads[index].fd = -1;
+            on_file(index, std::move(content));
+        };
+        const auto queue_rest = [&](const size_t index)
+        {
+            auto &read = reads[index];
+            read.iov.iov_base = read.content.data() + read.done;
+            read.iov.iov_len = read.content.size() - read.done;
+            return ring->queue_read(read.fd, &read.iov, read.done, index);
+        };
+
+        size_t next = 0;
+        size_t in_flight = 0;
+        while (next < paths.size() || in_flight > 0)
+        {
+            // open and size files while there is room in the ring
+            while (next < paths.size() && in_flight < ring->entries())
+            {
+                const size_t index = next++;
+                auto &read = reads[index];
+                read.fd = open(paths[index].c_str(), O_RDONLY | O_CLOEXEC);
+
+                struct stat info;
+                if (read.fd < 0 || fstat(read.fd, &info) != 0)
+                {
+                    finish(index, std::nullopt);
+                    continue;
+                }
+                if (info.st_size == 0)
+                {
+                    finish(index, std::string());
+                    continue;
+                }
+
+                read.content.resize(static_cast<size_t>(info.st_size));
+                if (!queue_rest(index))
+                {
+                    finish(index, read_fd(read.fd));
+                    continue;
+                }
+                ++in_flight;
+            }
+
+            if (in_flight == 0) continue;
+            if (!ring->submit_and_wait(1))
+            {
+                // the ring broke mid-batch. Reads the kernel already took can
+                // still write into their buffers, so reap their completions
+                // before anything is finished or freed
+                size_t owned = in_flight - ring->unsubmitted();
+                for (int attempt = 0; owned > 0 && attempt < 1000; ++attempt)
+                {
+                    ring->drain([&](uint64_t, int) { --owned; });
+                    if (owned > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                // finish what is left synchronously into fresh buffers
+                for (size_t index = 0; index < next; ++index)
+                {
+                    if (reads[index].fd >= 0) finish(index, read_fd(reads[index].fd));
+                }
+                for (; next < paths.size(); ++next)
+                {
+                    on_file(next, read_file(paths[next]));
+                }
+
+                if (owned > 0)
+                {
+                    // the kernel never returned some reads; leak their buffers
+                    // and the ring rather than let it write into freed memory
+                    ring.release();
+                    static_cast<void>(new std::vector<Read>(std::move(reads)));
+                }
+                return true;
+            }
+
+            std::vector<size_t> resubmit;
+            ring->drain(
+                [&](const uint64_t user_data, const int result)
+                {
+                    const size_t index = static_cast<size_t>(user_data);
+                    auto &read = reads[index];
+                    if (result < 0)
+                    {
+                        --in_flight;
+                        finish(index, read_fd(read.fd));
+                    }
+                    else if (result == 0 || read.done + static_cast<size_t>(result) >= read.content.size())
+                    {
+                        --in_flight;
+                        read.content.resize(read.done + static_cast<size_t>(result));
+                        finish(index, std::move(read.content));
+                    }
+                    else
+                    {
+                        // short read: go again for the remainder
+                        read.done += static_cast<size_t>(result);
+                        resubmit.push_back(index);
+                    }
+                });
+
+            for (const size_t index : resubmit)
+            {
+                if (!queue_rest(index))
+                {
+                    --in_flight;
+                    finish(index, read_fd(reads[index].fd));
+                }
+            }
+        }
+
+        return true;
+    }
+#endif
+};
+
+struct AsyncLoadResult
+{
+    IoBackend backend = IoBackend::Auto;
+    size_t files_read = 0;
+    size_t types_registered = 0;
+    std::vector<std::string> failed_files;   // unreadable, or a block failed to parse
+    std::vector<std::string> rejected_types; // refused by register_type (name hash collision)
+};
+
+class AsyncSchemaLoader
+{
+private:
+    struct ParsedFile
+    {
+        size_t index = 0;
+        bool ok = false;
+        std::vector<std::unique_ptr<TypeDescriptor>> types;
+    };
+
+public:
+    // read -> parse -> register. Files may hold several types (blank-line
+    // separated blocks, as for SchemaLibrary). A type is registered once
+    // its base is; types whose base never shows up are registered at the
+    // end so nothing is dropped silently.
+    static AsyncLoadResult load(const std::vector<std::string> &paths, const IoBackend backend = IoBackend::Auto,
+                                const size_t parse_threads = 0)
+    {
+        AsyncLoadResult result;
+        StageQueue<std::pair<size_t, std::optional<std::string>>> read_queue;
+        StageQueue<ParsedFile> parsed_queue;
+
+        std::thread reader(
+            [&]
+            {
+                result.backend = AsyncFileReader::read_all(
+                    paths, [&](const size_t index, std::optional<std::string> content)
+                    { read_queue.push({index, std::move(content)}); },
+                    backend);
+                read_queue.close();
+            });
+
+        const size_t parsers = parse_threads ? parse_threads : std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<size_t> parsers_left{parsers};
+        std::vector<std::thread> parse_pool;
+        for (size_t i = 0; i < parsers; ++i)
+        {
+            parse_pool.emplace_back(
+                [&]
+                {
+                    while (auto item = read_queue.pop())
+                    {
+                        parsed_queue.push(parse(item->first, std::move(item->second)));
+                    }
+                    if (--parsers_left == 0) parsed_queue.close();
+                });
+        }
+
+        // registration stays on this thread so its order is the only
+        // ordering that matters for the registry
+        std::unordered_map<std::string, std::vector<std::unique_ptr<TypeDescriptor>>> waiting_for_base;
+        while (auto file = parsed_queue.pop())
+        {
+            if (!file->ok)
+            {
+                result.failed_files.push_back(paths[file->index]);
+                continue;
+            }
+
+            ++result.files_read;
+            for (auto &type : file->types)
+            {
+                const auto &base = type->base_type_name;
+                if (!base.empty() && !TypeRegistry::instance().get_type(base))
+                {
+                    waiting_for_base[base].push_back(std::move(type));
+                    continue;
+                }
+                register_with_dependents(std::move(type), waiting_for_base, result);
+            }
+        }
+
+        for (auto &[base, types] : waiting_for_base)
+        {
+            for (auto &type : types)
+            {
+                register_with_dependents(std::move(type), waiting_for_base, result);
+            }
+        }
+
+        reader.join();
+        for (auto &thread : parse_pool)
+        {
+            thread.join();
+        }
+
+        return result;
+    }
+
+private:
+    static ParsedFile parse(const size_t index, std::optional<std::string> content)
+    {
+        ParsedFile file;
+        file.index = index;
+        if (!content) return file;
+
+        // malformed numeric defaults throw from std::stoi/std::stod
+        try
+        {
+            file.types = PropertyFileParser::parse_blocks(*content);
+            file.ok = true;
+        }
+        catch (const std::exception &)
+        {
+            file.types.clear();
+        }
+
+        return file;
+    }
+
+    static void
+    register_with_dependents(std::unique_ptr<TypeDescriptor> type,
+                             std::unordered_map<std::string, std::vector<std::unique_ptr<TypeDescriptor>>> &waiting,
+                             AsyncLoadResult &result)
+    {
+        if (!type) return; // already released through an earlier base
+
+        std::vector<std::unique_ptr<TypeDescriptor>> ready;
+        ready.push_back(std::move(type));
+        while (!ready.empty())
+        {
+            auto next = std::move(ready.back());
+            ready.pop_back();
+
+            const auto name = next->type_name;
+            if (!TypeRegistry::instance().register_type(std::move(next)))
+            {
+                result.rejected_types.push_back(name);
+                continue;
+            }
+            ++result.types_registered;
+
+            if (const auto it = waiting.find(name); it != waiting.end())
+            {
+                for (auto &dependent : it->second)
+                {
+                    if (dependent) ready.push_back(std::move(dependent));
+                }
+            }
+        }
+    }
+};
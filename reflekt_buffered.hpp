@@ -0,0 +1,218 @@
+#pragma once
+
+// Double-buffered read access to an ObjectStore.
+//
+// The simulation keeps mutating its ObjectStore as usual. At a sync point
+// it calls DoubleBufferedStore::sync(), which brings the back buffer up to
+// date and makes it the front one. Only the chunks the store stamped as
+// written since that buffer was last synced are copied (see
+// ObjectStore::chunk_versions). Reader threads call read() at any time and
+// get a view of the front buffer: a stable copy of the columns as of the
+// last sync, with no locks and no torn values.
+//
+// read() pins a buffer through a per-buffer reader count; sync() waits for
+// the back buffer's readers to drain before overwriting it. A view held
+// across two sync points stalls the second one until it is dropped, so
+// hold views for at most a frame.
+
+#include "reflekt.hpp"
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class DoubleBufferedStore
+{
+private:
+    struct Buffer
+    {
+        std::vector<Column> columns;
+        std::vector<ObjectHandle> handles;   // per row
+        std::vector<uint32_t> row_of_index;  // handle index -> row
+        uint64_t synced_version = 0;
+        uint64_t synced_structure = UINT64_MAX;
+        uint64_t tick = 0;
+    };
+
+    const ObjectStore &live_;
+    Buffer buffers_[2];
+    mutable std::atomic<uint32_t> readers_[2] = {};
+    std::atomic<uint32_t> front_{0};
+    uint64_t tick_ = 0;
+    size_t last_copied_chunks_ = 0;
+
+public:
+    class ReadView
+    {
+    private:
+        const DoubleBufferedStore *owner_;
+        const Buffer *buffer_;
+        std::atomic<uint32_t> *readers_;
+
+        friend class DoubleBufferedStore;
+
+        ReadView(const DoubleBufferedStore *owner, const Buffer *buffer, std::atomic<uint32_t> *readers) :
+            owner_(owner), buffer_(buffer), readers_(readers)
+        {
+        }
+
+    public:
+        ReadView(const ReadView &) = delete;
+        ReadView &operator=(const ReadView &) = delete;
+        ReadView(ReadView &&other) noexcept :
+            owner_(other.owner_), buffer_(other.buffer_), readers_(std::exchange(other.readers_, nullptr))
+        {
+        }
+
+        ~ReadView()
+        {
+            if (readers_) readers_->fetch_sub(1, std::memory_order_release);
+        }
+
+        // the sync() count at which this copy was taken; 0 before the first sync
+        [[nodiscard]] uint64_t tick() const { return buffer_->tick; }
+        [[nodiscard]] size_t size() const { return buffer_->handles.size(); }
+        [[nodiscard]] const Column &get_column(const size_t slot) const { return buffer_->columns[slot]; }
+        [[nodiscard]] ObjectHandle handle_at(const size_t row) const { return buffer_->handles[row]; }
+
+        [[nodiscard]] std::optional<size_t> row_of(const ObjectHandle handle) const
+        {
+            if (handle.index >= buffer_->row_of_index.size()) return std::nullopt;
+
+            const uint32_t row = buffer_->row_of_index[handle.index];
+            return row < buffer_->handles.size() && buffer_->handles[row] == handle ? std::optional<size_t>(row)
+                                                                                    : std::nullopt;
+        }
+
+        [[nodiscard]] PropertyValue get_value(const size_t row, const size_t slot) const
+        {
+            return std::visit([row](const auto &values) { return to_property_value(values[row]); },
+                              buffer_->columns[slot]);
+        }
+
+        template <typename T>
+        [[nodiscard]] std::optional<T> get_property(const ObjectHandle handle, const std::string &name) const
+        {
+            const auto slot = owner_->live_.find_slot(name);
+            const auto row = row_of(handle);
+            if (!slot || !row) return std::nullopt;
+
+            const auto value = get_value(*row, *slot);
+            if (std::holds_alternative<T>(value))
+            {
+                return std::get<T>(value);
+            }
+
+            return std::nullopt;
+        }
+    };
+
+    // `live` must outlive this object
+    explicit DoubleBufferedStore(const ObjectStore &live) : live_(live)
+    {
+        for (auto &buffer : buffers_)
+        {
+            for (const auto &prop : live_.get_layout())
+            {
+                buffer.columns.push_back(make_column(value_kind_for(prop)));
+            }
+        }
+    }
+
+    DoubleBufferedStore(const DoubleBufferedStore &) = delete;
+    DoubleBufferedStore &operator=(const DoubleBufferedStore &) = delete;
+
+    // any thread, lock-free; the view stays on one buffer for its lifetime
+    [[nodiscard]] ReadView read() const
+    {
+        while (true)
+        {
+            const uint32_t index = front_.load();
+            readers_[index].fetch_add(1);
+            if (front_.load() == index) return ReadView(this, &buffers_[index], &readers_[index]);
+
+            // a sync flipped the buffers in between; the one we pinned may be
+            // the one it is writing
+            readers_[index].fetch_sub(1);
+        }
+    }
+
+    // writer thread only, at a point where the live store is not being
+    // mutated: refresh the back buffer from dirty chunks and publish it
+    void sync()
+    {
+        const uint32_t back = 1 - front_.load();
+        while (readers_[back].load() != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        auto &buffer = buffers_[back];
+        const size_t rows = live_.size();
+        const auto &versions = live_.chunk_versions();
+
+        for (auto &column : buffer.columns)
+        {
+            std::visit([rows](auto &values) { values.resize(rows); }, column);
+        }
+        buffer.handles.resize(rows);
+
+        last_copied_chunks_ = 0;
+        for (size_t chunk = 0; chunk < versions.size(); ++chunk)
+        {
+            const size_t begin = chunk * ObjectStore::version_chunk_rows;
+            if (begin >= rows) break;
+            if (versions[chunk] <= buffer.synced_version) continue;
+
+            const size_t end = std::min(rows, begin + ObjectStore::version_chunk_rows);
+            for (size_t slot = 0; slot < buffer.columns.size(); ++slot)
+            {
+                std::visit(
+                    [&](auto &values)
+                    {
+                        const auto &source = std::get<std::decay_t<decltype(values)>>(live_.get_column(slot));
+                        std::copy(source.begin() + begin, source.begin() + end, values.begin() + begin);
+                    },
+                    buffer.columns[slot]);
+            }
+            for (size_t row = begin; row < end; ++row)
+            {
+                buffer.handles[row] = live_.handle_at(row);
+            }
+            ++last_copied_chunks_;
+        }
+
+        if (buffer.synced_structure != live_.structure_version())
+        {
+            rebuild_row_index(buffer);
+            buffer.synced_structure = live_.structure_version();
+        }
+
+        buffer.synced_version = live_.version();
+        buffer.tick = ++tick_;
+        front_.store(back);
+    }
+
+    [[nodiscard]] uint64_t tick() const { return tick_; }
+    // chunks copied by the most recent sync(), for tuning chunk size and sync cadence
+    [[nodiscard]] size_t last_copied_chunks() const { return last_copied_chunks_; }
+
+private:
+    static void rebuild_row_index(Buffer &buffer)
+    {
+        uint32_t max_index = 0;
+        for (const auto &handle : buffer.handles)
+        {
+            max_index = std::max(max_index, handle.index + 1);
+        }
+
+        buffer.row_of_index.assign(max_index, UINT32_MAX);
+        for (uint32_t row = 0; row < buffer.handles.size(); ++row)
+        {
+            buffer.row_of_index[buffer.handles[row].index] = row;
+        }
+    }
+};
@@ -0,0 +1,429 @@
+#include "reflekt_c.h"
+
+#include "reflekt.hpp"
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+static_assert(sizeof(rk_handle) == sizeof(ObjectHandle) && offsetof(rk_handle, generation) == sizeof(uint32_t),
+              "rk_handle must mirror ObjectHandle so ref columns can be exposed in place");
+static_assert(static_cast<int>(RK_KIND_REF) == static_cast<int>(ValueKind::Ref), "rk_kind must mirror ValueKind");
+
+namespace
+{
+TypeRegistry *as_registry(rk_registry *registry) { return reinterpret_cast<TypeRegistry *>(registry); }
+const TypeRegistry *as_registry(const rk_registry *registry)
+{
+    return reinterpret_cast<const TypeRegistry *>(registry);
+}
+const TypeDescriptor *as_type(const rk_type *type) { return reinterpret_cast<const TypeDescriptor *>(type); }
+ObjectStore *as_store(rk_store *store) { return reinterpret_cast<ObjectStore *>(store); }
+const ObjectStore *as_store(const rk_store *store) { return reinterpret_cast<const ObjectStore *>(store); }
+DynamicObject *as_object(rk_object *object) { return reinterpret_cast<DynamicObject *>(object); }
+const DynamicObject *as_object(const rk_object *object) { return reinterpret_cast<const DynamicObject *>(object); }
+
+ObjectHandle to_handle(const rk_handle handle) { return {handle.index, handle.generation}; }
+rk_handle to_rk_handle(const ObjectHandle handle) { return {handle.index, handle.generation}; }
+
+// nothing may unwind across the C boundary: every entry point that calls
+// into the library runs its body through guarded or guarded_or
+template <typename Func>
+rk_status guarded(Func &&func) noexcept
+{
+    try
+    {
+        return func();
+    }
+    catch (const std::bad_alloc &)
+    {
+        return RK_ERR_INTERNAL;
+    }
+    catch (...)
+    {
+        return RK_ERR_UNKNOWN;
+    }
+}
+
+// the same for entry points that return no status; `failed` stands in
+template <typename Result, typename Func>
+Result guarded_or(const Result failed, Func &&func) noexcept
+{
+    try
+    {
+        return func();
+    }
+    catch (...)
+    {
+        return failed;
+    }
+}
+
+// stores and objects resolve their layout through the process registry
+bool is_process_registry(const rk_registry *registry)
+{
+    return as_registry(registry) == &TypeRegistry::instance();
+}
+
+template <typename Elem, typename Out>
+rk_status read_slot(const rk_store *store, const rk_handle handle, const size_t slot, Out *out_value)
+{
+    const auto *s = as_store(store);
+    if (!s || !out_value || slot >= s->slot_count()) return RK_ERR_NOT_FOUND;
+
+    const auto row = s->row_of(to_handle(handle));
+    if (!row) return RK_ERR_INVALID_HANDLE;
+
+    const auto *values = std::get_if<std::vector<Elem>>(&s->get_column(slot));
+    if (!values) return RK_ERR_TYPE_MISMATCH;
+
+    if constexpr (std::is_same_v<Elem, std::string>)
+    {
+        *out_value = (*values)[*row].c_str();
+    }
+    else if constexpr (std::is_same_v<Elem, ObjectHandle>)
+    {
+        *out_value = to_rk_handle((*values)[*row]);
+    }
+    else
+    {
+        *out_value = static_cast<Out>((*values)[*row]);
+    }
+    return RK_OK;
+}
+
+rk_status write_slot(rk_store *store, const rk_handle handle, const size_t slot, const PropertyValue &value)
+{
+    auto *s = as_store(store);
+    if (!s || slot >= s->slot_count()) return RK_ERR_NOT_FOUND;
+
+    const auto row = s->row_of(to_handle(handle));
+    if (!row) return RK_ERR_INVALID_HANDLE;
+
+    return s->set_value(*row, slot, value) ? RK_OK : RK_ERR_TYPE_MISMATCH;
+}
+
+template <typename T, typename Out>
+rk_status read_property(const rk_object *object, const char *name, Out *out_value)
+{
+    const auto *o = as_object(object);
+    if (!o || !name || !out_value) return RK_ERR_NOT_FOUND;
+
+    const auto *value = o->find_property(name);
+    if (!value) return RK_ERR_NOT_FOUND;
+    if (!std::holds_alternative<T>(*value)) return RK_ERR_TYPE_MISMATCH;
+
+    if constexpr (std::is_same_v<T, std::string>)
+    {
+        *out_value = std::get<T>(*value).c_str();
+    }
+    else
+    {
+        *out_value = static_cast<Out>(std::get<T>(*value));
+    }
+    return RK_OK;
+}
+
+template <typename T>
+rk_status write_property(rk_object *object, const char *name, const T &value)
+{
+    auto *o = as_object(object);
+    if (!o || !name) return RK_ERR_NOT_FOUND;
+
+    return o->set_property(name, value) ? RK_OK : RK_ERR_CONFLICT;
+}
+} // namespace
+
+extern "C" {
+
+uint32_t rk_abi_version(void) { return RK_ABI_VERSION; }
+
+rk_registry *rk_registry_get(void)
+{
+    return guarded_or<rk_registry *>(nullptr,
+                                     [] { return reinterpret_cast<rk_registry *>(&TypeRegistry::instance()); });
+}
+
+rk_status rk_registry_register_dsl(rk_registry *registry, const char *content)
+{
+    if (!registry || !content) return RK_ERR_NOT_FOUND;
+
+    return guarded(
+        [&]
+        {
+            std::unique_ptr<TypeDescriptor> type;
+            try
+            {
+                type = PropertyFileParser::parse_simple_format(content);
+            }
+            catch (const std::logic_error &)
+            {
+                // malformed default values
+                return RK_ERR_PARSE;
+            }
+            if (!type) return RK_ERR_PARSE;
+
+            return as_registry(registry)->register_type(std::move(type)) ? RK_OK : RK_ERR_CONFLICT;
+        });
+}
+
+const rk_type *rk_registry_find_type(const rk_registry *registry, const char *name)
+{
+    if (!registry || !name) return nullptr;
+
+    return guarded_or<const rk_type *>(
+        nullptr, [&] { return reinterpret_cast<const rk_type *>(as_registry(registry)->get_type(name)); });
+}
+
+const char *rk_type_name(const rk_type *type) { return type ? as_type(type)->type_name.c_str() : nullptr; }
+
+const char *rk_type_base_name(const rk_type *type) { return type ? as_type(type)->base_type_name.c_str() : nullptr; }
+
+size_t rk_type_property_count(const rk_type *type) { return type ? as_type(type)->properties.size() : 0; }
+
+const char *rk_type_property_name(const rk_type *type, const size_t index)
+{
+    if (!type || index >= as_type(type)->properties.size()) return nullptr;
+
+    return as_type(type)->properties[index].name.c_str();
+}
+
+const char *rk_type_property_type(const rk_type *type, const size_t index)
+{
+    if (!type || index >= as_type(type)->properties.size()) return nullptr;
+
+    return as_type(type)->properties[index].type_name.c_str();
+}
+
+rk_store *rk_store_create(const rk_registry *registry, const char *type_name)
+{
+    if (!registry || !type_name || !is_process_registry(registry)) return nullptr;
+
+    return guarded_or<rk_store *>(nullptr,
+                                  [&]() -> rk_store *
+                                  {
+                                      if (!as_registry(registry)->get_type(type_name)) return nullptr;
+
+                                      return reinterpret_cast<rk_store *>(new ObjectStore(type_name));
+                                  });
+}
+
+void rk_store_destroy(rk_store *store) { delete as_store(store); }
+
+size_t rk_store_size(const rk_store *store) { return store ? as_store(store)->size() : 0; }
+
+size_t rk_store_slot_count(const rk_store *store) { return store ? as_store(store)->slot_count() : 0; }
+
+rk_status rk_store_find_slot(const rk_store *store, const char *name, size_t *out_slot)
+{
+    if (!store || !name || !out_slot) return RK_ERR_NOT_FOUND;
+
+    return guarded(
+        [&]
+        {
+            const auto slot = as_store(store)->find_slot(name);
+            if (!slot) return RK_ERR_NOT_FOUND;
+
+            *out_slot = *slot;
+            return RK_OK;
+        });
+}
+
+const char *rk_store_slot_name(const rk_store *store, const size_t slot)
+{
+    if (!store || slot >= as_store(store)->slot_count()) return nullptr;
+
+    return guarded_or<const char *>(nullptr, [&] { return as_store(store)->get_layout()[slot].name.c_str(); });
+}
+
+rk_kind rk_store_slot_kind(const rk_store *store, const size_t slot)
+{
+    if (!store || slot >= as_store(store)->slot_count()) return RK_KIND_INVALID;
+
+    return guarded_or(RK_KIND_INVALID, [&] { return static_cast<rk_kind>(as_store(store)->get_column(slot).index()); });
+}
+
+rk_status rk_store_create_object(rk_store *store, rk_handle *out_handle)
+{
+    if (!store || !out_handle) return RK_ERR_NOT_FOUND;
+
+    return guarded(
+        [&]
+        {
+            *out_handle = to_rk_handle(as_store(store)->create());
+            return RK_OK;
+        });
+}
+
+rk_status rk_store_destroy_object(rk_store *store, const rk_handle handle)
+{
+    if (!store) return RK_ERR_NOT_FOUND;
+
+    return guarded([&] { return as_store(store)->destroy(to_handle(handle)) ? RK_OK : RK_ERR_INVALID_HANDLE; });
+}
+
+rk_status rk_store_row_of(const rk_store *store, const rk_handle handle, size_t *out_row)
+{
+    if (!store || !out_row) return RK_ERR_NOT_FOUND;
+
+    return guarded(
+        [&]
+        {
+            const auto row = as_store(store)->row_of(to_handle(handle));
+            if (!row) return RK_ERR_INVALID_HANDLE;
+
+            *out_row = *row;
+            return RK_OK;
+        });
+}
+
+rk_handle rk_store_handle_at(const rk_store *store, const size_t row)
+{
+    if (!store || row >= as_store(store)->size()) return to_rk_handle(ObjectHandle());
+
+    return guarded_or(to_rk_handle(ObjectHandle()), [&] { return to_rk_handle(as_store(store)->handle_at(row)); });
+}
+
+rk_status rk_store_get_int(const rk_store *store, const rk_handle handle, const size_t slot, int32_t *out_value)
+{
+    return guarded([&] { return read_slot<int>(store, handle, slot, out_value); });
+}
+
+rk_status rk_store_get_double(const rk_store *store, const rk_handle handle, const size_t slot, double *out_value)
+{
+    return guarded([&] { return read_slot<double>(store, handle, slot, out_value); });
+}
+
+rk_status rk_store_get_bool(const rk_store *store, const rk_handle handle, const size_t slot, int *out_value)
+{
+    return guarded([&] { return read_slot<uint8_t>(store, handle, slot, out_value); });
+}
+
+rk_status rk_store_get_ref(const rk_store *store, const rk_handle handle, const size_t slot, rk_handle *out_value)
+{
+    return guarded([&] { return read_slot<ObjectHandle>(store, handle, slot, out_value); });
+}
+
+rk_status rk_store_get_string(const rk_store *store, const rk_handle handle, const size_t slot,
+                              const char **out_value)
+{
+    return guarded([&] { return read_slot<std::string>(store, handle, slot, out_value); });
+}
+
+rk_status rk_store_set_int(rk_store *store, const rk_handle handle, const size_t slot, const int32_t value)
+{
+    return guarded([&] { return write_slot(store, handle, slot, static_cast<int>(value)); });
+}
+
+rk_status rk_store_set_double(rk_store *store, const rk_handle handle, const size_t slot, const double value)
+{
+    return guarded([&] { return write_slot(store, handle, slot, value); });
+}
+
+rk_status rk_store_set_bool(rk_store *store, const rk_handle handle, const size_t slot, const int value)
+{
+    return guarded([&] { return write_slot(store, handle, slot, value != 0); });
+}
+
+rk_status rk_store_set_ref(rk_store *store, const rk_handle handle, const size_t slot, const rk_handle value)
+{
+    return guarded([&] { return write_slot(store, handle, slot, to_handle(value)); });
+}
+
+rk_status rk_store_set_string(rk_store *store, const rk_handle handle, const size_t slot, const char *value)
+{
+    if (!value) return RK_ERR_NOT_FOUND;
+
+    return guarded([&] { return write_slot(store, handle, slot, std::string(value)); });
+}
+
+rk_status rk_store_column(const rk_store *store, const size_t slot, rk_column_view *out_view)
+{
+    if (!store || !out_view || slot >= as_store(store)->slot_count()) return RK_ERR_NOT_FOUND;
+
+    return guarded(
+        [&]
+        {
+            const auto &column = as_store(store)->get_column(slot);
+            return std::visit(
+                [&](const auto &values)
+                {
+                    using Elem = typename std::decay_t<decltype(values)>::value_type;
+                    if constexpr (std::is_same_v<Elem, std::string>)
+                    {
+                        return RK_ERR_TYPE_MISMATCH;
+                    }
+                    else
+                    {
+                        out_view->data = values.data();
+                        out_view->stride = sizeof(Elem);
+                        out_view->count = values.size();
+                        out_view->kind = static_cast<rk_kind>(column.index());
+                        return RK_OK;
+                    }
+                },
+                column);
+        });
+}
+
+rk_object *rk_object_create(const rk_registry *registry, const char *type_name)
+{
+    if (!registry || !type_name || !is_process_registry(registry)) return nullptr;
+
+    return guarded_or<rk_object *>(
+        nullptr, [&] { return reinterpret_cast<rk_object *>(ObjectFactory::create(type_name).release()); });
+}
+
+void rk_object_destroy(rk_object *object) { delete as_object(object); }
+
+const char *rk_object_type_name(const rk_object *object)
+{
+    if (!object) return nullptr;
+
+    return guarded_or<const char *>(nullptr, [&] { return as_object(object)->get_type_name().c_str(); });
+}
+
+rk_status rk_object_get_int(const rk_object *object, const char *name, int32_t *out_value)
+{
+    return guarded([&] { return read_property<int>(object, name, out_value); });
+}
+
+rk_status rk_object_get_double(const rk_object *object, const char *name, double *out_value)
+{
+    return guarded([&] { return read_property<double>(object, name, out_value); });
+}
+
+rk_status rk_object_get_bool(const rk_object *object, const char *name, int *out_value)
+{
+    return guarded([&] { return read_property<bool>(object, name, out_value); });
+}
+
+rk_status rk_object_get_string(const rk_object *object, const char *name, const char **out_value)
+{
+    return guarded([&] { return read_property<std::string>(object, name, out_value); });
+}
+
+rk_status rk_object_set_int(rk_object *object, const char *name, const int32_t value)
+{
+    return guarded([&] { return write_property(object, name, static_cast<int>(value)); });
+}
+
+rk_status rk_object_set_double(rk_object *object, const char *name, const double value)
+{
+    return guarded([&] { return write_property(object, name, value); });
+}
+
+rk_status rk_object_set_bool(rk_object *object, const char *name, const int value)
+{
+    return guarded([&] { return write_property(object, name, value != 0); });
+}
+
+rk_status rk_object_set_string(rk_object *object, const char *name, const char *value)
+{
+    if (!value) return RK_ERR_NOT_FOUND;
+
+    return guarded([&] { return write_property(object, name, std::string(value)); });
+}
+
+} // extern "C"
@@ -0,0 +1,137 @@
+#ifndef REFLEKT_C_H
+#define REFLEKT_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#if defined(REFLEKT_C_BUILD)
+#define RK_API __declspec(dllexport)
+#else
+#define RK_API __declspec(dllimport)
+#endif
+#else
+#define RK_API __attribute__((visibility("default")))
+#endif
+
+/* bumped whenever a signature or struct layout below changes */
+#define RK_ABI_VERSION 2
+
+/* all handles are opaque; registries and types are owned by the library,
+   stores and objects by the caller (release with the matching *_destroy) */
+typedef struct rk_registry rk_registry;
+typedef struct rk_type rk_type;
+typedef struct rk_store rk_store;
+typedef struct rk_object rk_object;
+
+/* same layout as ObjectHandle */
+typedef struct rk_handle
+{
+    uint32_t index;
+    uint32_t generation;
+} rk_handle;
+
+typedef enum rk_kind
+{
+    RK_KIND_INVALID = -1, /* no such store or slot */
+    RK_KIND_INT = 0,
+    RK_KIND_DOUBLE = 1,
+    RK_KIND_STRING = 2,
+    RK_KIND_BOOL = 3,
+    RK_KIND_REF = 4
+} rk_kind;
+
+typedef enum rk_status
+{
+    RK_OK = 0,
+    RK_ERR_NOT_FOUND = 1,
+    RK_ERR_TYPE_MISMATCH = 2,
+    RK_ERR_INVALID_HANDLE = 3,
+    RK_ERR_PARSE = 4,
+    RK_ERR_INTERNAL = 5,
+    RK_ERR_CONFLICT = 6, /* name hash collides with an already registered name */
+    RK_ERR_UNKNOWN = 7   /* the library failed in a way it could not classify */
+} rk_status;
+
+/* direct view of one store column: element i lives at
+   (const char *)data + i * stride. Valid until the store is next mutated.
+   bools are one byte (0/1), refs are rk_handle. */
+typedef struct rk_column_view
+{
+    const void *data;
+    size_t stride;
+    size_t count;
+    rk_kind kind;
+} rk_column_view;
+
+RK_API uint32_t rk_abi_version(void);
+
+/* registry */
+RK_API rk_registry *rk_registry_get(void);
+RK_API rk_status rk_registry_register_dsl(rk_registry *registry, const char *content);
+RK_API const rk_type *rk_registry_find_type(const rk_registry *registry, const char *name);
+
+/* types (own properties only; a store's slots include inherited ones) */
+RK_API const char *rk_type_name(const rk_type *type);
+RK_API const char *rk_type_base_name(const rk_type *type);
+RK_API size_t rk_type_property_count(const rk_type *type);
+RK_API const char *rk_type_property_name(const rk_type *type, size_t index);
+RK_API const char *rk_type_property_type(const rk_type *type, size_t index);
+
+/* stores: resolve slots once, then address values by (handle, slot).
+   Stores and objects lay themselves out through the process registry, so
+   `registry` must be the one rk_registry_get returns. */
+RK_API rk_store *rk_store_create(const rk_registry *registry, const char *type_name);
+RK_API void rk_store_destroy(rk_store *store);
+RK_API size_t rk_store_size(const rk_store *store);
+RK_API size_t rk_store_slot_count(const rk_store *store);
+RK_API rk_status rk_store_find_slot(const rk_store *store, const char *name, size_t *out_slot);
+RK_API const char *rk_store_slot_name(const rk_store *store, size_t slot);
+RK_API rk_kind rk_store_slot_kind(const rk_store *store, size_t slot);
+
+RK_API rk_status rk_store_create_object(rk_store *store, rk_handle *out_handle);
+RK_API rk_status rk_store_destroy_object(rk_store *store, rk_handle handle);
+RK_API rk_status rk_store_row_of(const rk_store *store, rk_handle handle, size_t *out_row);
+RK_API rk_handle rk_store_handle_at(const rk_store *store, size_t row);
+
+RK_API rk_status rk_store_get_int(const rk_store *store, rk_handle handle, size_t slot, int32_t *out_value);
+RK_API rk_status rk_store_get_double(const rk_store *store, rk_handle handle, size_t slot, double *out_value);
+RK_API rk_status rk_store_get_bool(const rk_store *store, rk_handle handle, size_t slot, int *out_value);
+RK_API rk_status rk_store_get_ref(const rk_store *store, rk_handle handle, size_t slot, rk_handle *out_value);
+/* the string stays owned by the store; valid until the store is next mutated */
+RK_API rk_status rk_store_get_string(const rk_store *store, rk_handle handle, size_t slot, const char **out_value);
+
+RK_API rk_status rk_store_set_int(rk_store *store, rk_handle handle, size_t slot, int32_t value);
+RK_API rk_status rk_store_set_double(rk_store *store, rk_handle handle, size_t slot, double value);
+RK_API rk_status rk_store_set_bool(rk_store *store, rk_handle handle, size_t slot, int value);
+RK_API rk_status rk_store_set_ref(rk_store *store, rk_handle handle, size_t slot, rk_handle value);
+RK_API rk_status rk_store_set_string(rk_store *store, rk_handle handle, size_t slot, const char *value);
+
+/* zero-copy batch access; string columns have no C layout and report
+   RK_ERR_TYPE_MISMATCH, read those per value */
+RK_API rk_status rk_store_column(const rk_store *store, size_t slot, rk_column_view *out_view);
+
+/* standalone objects */
+RK_API rk_object *rk_object_create(const rk_registry *registry, const char *type_name);
+RK_API void rk_object_destroy(rk_object *object);
+RK_API const char *rk_object_type_name(const rk_object *object);
+
+RK_API rk_status rk_object_get_int(const rk_object *object, const char *name, int32_t *out_value);
+RK_API rk_status rk_object_get_double(const rk_object *object, const char *name, double *out_value);
+RK_API rk_status rk_object_get_bool(const rk_object *object, const char *name, int *out_value);
+RK_API rk_status rk_object_get_string(const rk_object *object, const char *name, const char **out_value);
+
+RK_API rk_status rk_object_set_int(rk_object *object, const char *name, int32_t value);
+RK_API rk_status rk_object_set_double(rk_object *object, const char *name, double value);
+RK_API rk_status rk_object_set_bool(rk_object *object, const char *name, int value);
+RK_API rk_status rk_object_set_string(rk_object *object, const char *name, const char *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REFLEKT_C_H */
@@ -0,0 +1,353 @@
+#pragma once
+
+// Change sets between two stores of the same type, e.g. a snapshot (a copy
+// of the store) and the live store, or the same simulation run on two
+// machines.
+//
+// Objects are matched by handle, so both sides must share their handle
+// history: a copy of a store, or a deterministic replay. Values compare
+// bitwise, so -0.0 differs from 0.0 and a NaN matches an identical NaN.
+//
+// Rows are compared a chunk of ObjectStore::version_chunk_rows rows at a
+// time. Where both sides hold the same objects in the same rows, each
+// column range is compared with one memcmp and only mismatching ranges
+// are walked element by element; rows that moved are matched through the
+// handle. StoreDigest keeps one hash per chunk so a side that is diffed
+// repeatedly (a baseline snapshot, or a remote peer that only sends its
+// digest) can skip identical chunks without touching their columns.
+//
+// StoreDiff::apply replays a change set onto a store that holds the old
+// side, recreating added objects under their original handles.
+
+#include "reflekt.hpp"
+
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+struct SlotChange
+{
+    ObjectHandle handle;
+    size_t slot;
+    PropertyValue value; // the new value
+};
+
+struct StoreChangeSet
+{
+    std::vector<ObjectHandle> added;   // alive only in the new store
+    std::vector<ObjectHandle> removed; // alive only in the old store
+    // differing values of objects alive in both, and every value of each
+    // added object, grouped by chunk of rows
+    std::vector<SlotChange> changed;
+
+    [[nodiscard]] bool empty() const { return added.empty() && removed.empty() && changed.empty(); }
+};
+
+// per-chunk hashes over handles and all columns of a store
+struct StoreDigest
+{
+    size_t rows = 0;
+    std::vector<uint64_t> chunk_hashes;
+
+    [[nodiscard]] static StoreDigest compute(const ObjectStore &store)
+    {
+        StoreDigest digest;
+        digest.rows = store.size();
+
+        const size_t chunk_rows = ObjectStore::version_chunk_rows;
+        const size_t chunk_count = (digest.rows + chunk_rows - 1) / chunk_rows;
+        digest.chunk_hashes.resize(chunk_count);
+        parallel_for_chunks(chunk_count, parallel_chunk_count(digest.rows),
+                            [&](size_t, const size_t begin, const size_t end)
+                            {
+                                for (size_t chunk = begin; chunk < end; ++chunk)
+                                {
+                                    const size_t first = chunk * chunk_rows;
+                                    digest.chunk_hashes[chunk] =
+                                        hash_rows(store, first, std::min(digest.rows, first + chunk_rows));
+                                }
+                            });
+        return digest;
+    }
+
+    // chunks whose hashes differ, including chunks only one side has
+    [[nodiscard]] std::vector<size_t> differing_chunks(const StoreDigest &other) const
+    {
+        std::vector<size_t> chunks;
+        const size_t count = std::max(chunk_hashes.size(), other.chunk_hashes.size());
+        for (size_t chunk = 0; chunk < count; ++chunk)
+        {
+            if (chunk >= chunk_hashes.size() || chunk >= other.chunk_hashes.size() ||
+                chunk_hashes[chunk] != other.chunk_hashes[chunk])
+            {
+                chunks.push_back(chunk);
+            }
+        }
+        return chunks;
+    }
+
+    [[nodiscard]] bool operator==(const StoreDigest &other) const
+    {
+        return rows == other.rows && chunk_hashes == other.chunk_hashes;
+    }
+    [[nodiscard]] bool operator!=(const StoreDigest &other) const { return !(*this == other); }
+
+private:
+    // word-at-a-time multiply/xor mix; not cryptographic, only for
+    // telling chunks apart
+    static uint64_t mix(uint64_t hash, const uint64_t word)
+    {
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+        return hash ^ (hash >> 29);
+    }
+
+    static uint64_t hash_bytes(uint64_t hash, const void *data, const size_t size)
+    {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, 8);
+            hash = mix(hash, word);
+        }
+
+        uint64_t tail = 0;
+        std::memcpy(&tail, bytes + i, size - i);
+        return mix(hash, tail ^ (static_cast<uint64_t>(size) << 56));
+    }
+
+    static uint64_t hash_rows(const ObjectStore &store, const size_t begin, const size_t end)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t row = begin; row < end; ++row)
+        {
+            const ObjectHandle handle = store.handle_at(row);
+            hash = mix(hash, static_cast<uint64_t>(handle.index) << 32 | handle.generation);
+        }
+
+        for (size_t slot = 0; slot < store.slot_count(); ++slot)
+        {
+            std::visit(
+                [&](const auto &values)
+                {
+                    using Elem = typename std::decay_t<decltype(values)>::value_type;
+                    if constexpr (std::is_same_v<Elem, std::string>)
+                    {
+                        for (size_t row = begin; row < end; ++row)
+                        {
+                            hash = hash_bytes(hash, values[row].data(), values[row].size());
+                        }
+                    }
+                    else
+                    {
+                        hash = hash_bytes(hash, values.data() + begin, (end - begin) * sizeof(Elem));
+                    }
+                },
+                store.get_column(slot));
+        }
+        return hash;
+    }
+};
+
+class StoreDiff
+{
+public:
+    // nullopt if the stores hold different types. Digests, when given, must
+    // be of the stores as they are now; chunks whose hashes match on both
+    // sides are skipped.
+    [[nodiscard]] static std::optional<StoreChangeSet> diff(const ObjectStore &old_store, const ObjectStore &new_store,
+                                                            const StoreDigest *old_digest = nullptr,
+                                                            const StoreDigest *new_digest = nullptr)
+    {
+        if (old_store.get_type_name() != new_store.get_type_name() ||
+            old_store.slot_count() != new_store.slot_count())
+        {
+            return std::nullopt;
+        }
+
+        const size_t chunk_rows = ObjectStore::version_chunk_rows;
+        const size_t rows = new_store.size();
+        const size_t chunk_count = (rows + chunk_rows - 1) / chunk_rows;
+        const size_t workers = parallel_chunk_count(rows);
+
+        std::vector<StoreChangeSet> partials(workers);
+        parallel_for_chunks(chunk_count, workers,
+                            [&](const size_t worker, const size_t begin, const size_t end)
+                            {
+                                for (size_t chunk = begin; chunk < end; ++chunk)
+                                {
+                                    if (old_digest && new_digest && chunk < old_digest->chunk_hashes.size() &&
+                                        chunk < new_digest->chunk_hashes.size() &&
+                                        old_digest->chunk_hashes[chunk] == new_digest->chunk_hashes[chunk])
+                                    {
+                                        continue;
+                                    }
+
+                                    const size_t first = chunk * chunk_rows;
+                                    diff_chunk(old_store, new_store, first, std::min(rows, first + chunk_rows),
+                                               partials[worker]);
+                                }
+                            });
+
+        StoreChangeSet changes;
+        for (auto &partial : partials)
+        {
+            changes.added.insert(changes.added.end(), partial.added.begin(), partial.added.end());
+            changes.changed.insert(changes.changed.end(), std::make_move_iterator(partial.changed.begin()),
+                                   std::make_move_iterator(partial.changed.end()));
+        }
+
+        for (size_t row = 0; row < old_store.size(); ++row)
+        {
+            const ObjectHandle handle = old_store.handle_at(row);
+            if (!new_store.is_alive(handle)) changes.removed.push_back(handle);
+        }
+        return changes;
+    }
+
+    // turns `store` (the old side of `changes`) into the new side: removed
+    // objects are destroyed, added ones created under their handles, then
+    // the changed values written. Nothing is touched and false is returned
+    // if the change set does not fit the store.
+    static bool apply(ObjectStore &store, const StoreChangeSet &changes)
+    {
+        // generation each removed index is retired at
+        std::unordered_map<uint32_t, uint32_t> removed;
+        for (const auto &handle : changes.removed)
+        {
+            if (!store.is_alive(handle) || !removed.emplace(handle.index, handle.generation).second) return false;
+        }
+
+        std::unordered_map<uint32_t, uint32_t> added;
+        for (const auto &handle : changes.added)
+        {
+            const auto it = removed.find(handle.index);
+            const bool creatable =
+                it != removed.end() ? handle.generation > it->second : store.can_create_at(handle);
+            if (!creatable || !added.emplace(handle.index, handle.generation).second) return false;
+        }
+
+        for (const auto &change : changes.changed)
+        {
+            const auto it = added.find(change.handle.index);
+            const bool target = it != added.end()
+                                    ? it->second == change.handle.generation
+                                    : store.is_alive(change.handle) && !removed.count(change.handle.index);
+            if (!target || change.slot >= store.slot_count() ||
+                change.value.index() != store.get_column(change.slot).index())
+            {
+                return false;
+            }
+        }
+
+        for (const auto &handle : changes.removed)
+        {
+            store.destroy(handle);
+        }
+        for (const auto &handle : changes.added)
+        {
+            store.create_at(handle);
+        }
+        for (const auto &change : changes.changed)
+        {
+            store.set_value(*store.row_of(change.handle), change.slot, change.value);
+        }
+        return true;
+    }
+
+private:
+    static void diff_chunk(const ObjectStore &old_store, const ObjectStore &new_store, const size_t begin,
+                           const size_t end, StoreChangeSet &out)
+    {
+        bool aligned = end <= old_store.size();
+        for (size_t row = begin; aligned && row < end; ++row)
+        {
+            aligned = old_store.handle_at(row) == new_store.handle_at(row);
+        }
+
+        if (aligned)
+        {
+            diff_aligned(old_store, new_store, begin, end, out);
+            return;
+        }
+
+        for (size_t row = begin; row < end; ++row)
+        {
+            const ObjectHandle handle = new_store.handle_at(row);
+            const auto old_row = old_store.row_of(handle);
+            if (!old_row)
+            {
+                out.added.push_back(handle);
+                for (size_t slot = 0; slot < new_store.slot_count(); ++slot)
+                {
+                    out.changed.push_back({handle, slot, new_store.get_value(row, slot)});
+                }
+                continue;
+            }
+
+            for (size_t slot = 0; slot < new_store.slot_count(); ++slot)
+            {
+                std::visit(
+                    [&](const auto &values)
+                    {
+                        const auto &old_values = std::get<std::decay_t<decltype(values)>>(old_store.get_column(slot));
+                        if (!same_element(old_values[*old_row], values[row]))
+                        {
+                            out.changed.push_back({handle, slot, to_property_value(values[row])});
+                        }
+                    },
+                    new_store.get_column(slot));
+            }
+        }
+    }
+
+    // same objects in the same rows: one memcmp per column range, and only
+    // mismatching columns are walked
+    static void diff_aligned(const ObjectStore &old_store, const ObjectStore &new_store, const size_t begin,
+                             const size_t end, StoreChangeSet &out)
+    {
+        for (size_t slot = 0; slot < new_store.slot_count(); ++slot)
+        {
+            std::visit(
+                [&](const auto &values)
+                {
+                    using Values = std::decay_t<decltype(values)>;
+                    using Elem = typename Values::value_type;
+                    const auto &old_values = std::get<Values>(old_store.get_column(slot));
+
+                    if constexpr (std::is_trivially_copyable_v<Elem>)
+                    {
+                        if (std::memcmp(old_values.data() + begin, values.data() + begin,
+                                        (end - begin) * sizeof(Elem)) == 0)
+                        {
+                            return;
+                        }
+                    }
+
+                    for (size_t row = begin; row < end; ++row)
+                    {
+                        if (!same_element(old_values[row], values[row]))
+                        {
+                            out.changed.push_back({new_store.handle_at(row), slot, to_property_value(values[row])});
+                        }
+                    }
+                },
+                new_store.get_column(slot));
+        }
+    }
+
+    template <typename Elem>
+    static bool same_element(const Elem &a, const Elem &b)
+    {
+        if constexpr (std::is_trivially_copyable_v<Elem>)
+        {
+            return std::memcmp(&a, &b, sizeof(Elem)) == 0;
+        }
+        else
+        {
+            return a == b;
+        }
+    }
+};
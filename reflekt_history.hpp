@@ -0,0 +1,315 @@
+#pragma once
+
+// Rollback history for an ObjectStore.
+//
+// Properties declared with @history(N) (or on a type with @history(N)) keep
+// their last N ticks. The simulation calls record() once per tick; only the
+// chunks the store stamped as written since the previous record() are
+// compared against a shadow copy of the tracked columns, and only values
+// that actually changed go into that tick's ring entry, together with the
+// value they replaced. rewind_to(tick) walks the entries back and restores
+// every tracked property of every object in one pass.
+//
+// Only values are rewound, not object lifetimes: objects destroyed since
+// the tick stay destroyed, objects created since keep their current values,
+// and properties without @history are left alone.
+
+#include "reflekt.hpp"
+
+#include <optional>
+#include <vector>
+
+class StoreHistory
+{
+private:
+    // one ring entry: the values a slot had before `tick` for the objects
+    // whose value changed in it
+    struct Entry
+    {
+        uint64_t tick = 0; // 0 = unused or rewound past
+        std::vector<ObjectHandle> handles;
+        Column previous;
+    };
+
+    struct Track
+    {
+        size_t slot;
+        std::vector<Entry> ring; // history depth entries, by tick % depth
+        Column shadow;           // per row, as of the last record()
+    };
+
+    ObjectStore &store_;
+    std::vector<Track> tracks_;
+    std::vector<ObjectHandle> shadow_handles_;  // per row, as of the last record()
+    std::vector<uint32_t> shadow_row_of_index_; // handle index -> shadow row
+    uint64_t tick_ = 0;
+    uint64_t synced_version_ = 0;
+    uint64_t synced_structure_ = 0;
+
+public:
+    // `store` must outlive this object; the current state becomes tick 0
+    explicit StoreHistory(ObjectStore &store) : store_(store)
+    {
+        const auto &layout = store_.get_layout();
+        for (size_t slot = 0; slot < layout.size(); ++slot)
+        {
+            const uint32_t depth = layout[slot].arguments.history_depth;
+            if (!depth) continue;
+
+            const ValueKind kind = value_kind_for(layout[slot]);
+            Track track{slot, std::vector<Entry>(depth), make_column(kind)};
+            for (auto &entry : track.ring)
+            {
+                entry.previous = make_column(kind);
+            }
+            tracks_.push_back(std::move(track));
+        }
+
+        rebuild_shadow();
+    }
+
+    StoreHistory(const StoreHistory &) = delete;
+    StoreHistory &operator=(const StoreHistory &) = delete;
+
+    [[nodiscard]] uint64_t tick() const { return tick_; }
+    [[nodiscard]] size_t tracked_slot_count() const { return tracks_.size(); }
+
+    // closes the current tick; call once per simulation step
+    uint64_t record()
+    {
+        const uint64_t tick = ++tick_;
+        for (auto &track : tracks_)
+        {
+            auto &entry = track.ring[tick % track.ring.size()];
+            entry.tick = tick;
+            entry.handles.clear();
+            std::visit([](auto &values) { values.clear(); }, entry.previous);
+        }
+
+        if (store_.version() == synced_version_) return tick;
+
+        if (store_.structure_version() == synced_structure_)
+        {
+            // same rows as the shadow: compare the written chunks only
+            for_each_dirty_range(
+                [&](const size_t begin, const size_t end)
+                {
+                    for (auto &track : tracks_)
+                    {
+                        collect_changes(track, tick, begin, end, nullptr);
+                    }
+                });
+            copy_dirty_to_shadow();
+        }
+        else
+        {
+            // rows were added, removed or reordered: match them by handle
+            const auto shadow_rows = map_rows_to_shadow();
+            for (auto &track : tracks_)
+            {
+                collect_changes(track, tick, 0, store_.size(), &shadow_rows);
+            }
+            rebuild_shadow();
+        }
+
+        synced_version_ = store_.version();
+        return tick;
+    }
+
+    // true when every tracked slot still holds the ticks after `tick`
+    [[nodiscard]] bool can_rewind_to(const uint64_t tick) const
+    {
+        if (tick > tick_) return false;
+
+        for (const auto &track : tracks_)
+        {
+            if (tick_ - tick > track.ring.size()) return false;
+            for (uint64_t t = tick + 1; t <= tick_; ++t)
+            {
+                if (track.ring[t % track.ring.size()].tick != t) return false;
+            }
+        }
+        return true;
+    }
+
+    // restores tracked values to what they were at record() of `tick`
+    // (0 = construction). Writes made since the last record() are dropped
+    // as well. Nothing changes when the history does not reach back far
+    // enough; the next record() then continues from `tick`.
+    bool rewind_to(const uint64_t tick)
+    {
+        if (!can_rewind_to(tick)) return false;
+
+        discard_unrecorded();
+
+        for (uint64_t t = tick_; t > tick; --t)
+        {
+            for (auto &track : tracks_)
+            {
+                auto &entry = track.ring[t % track.ring.size()];
+                std::visit(
+                    [&](auto &shadow)
+                    {
+                        auto &previous = std::get<std::decay_t<decltype(shadow)>>(entry.previous);
+                        for (size_t i = 0; i < entry.handles.size(); ++i)
+                        {
+                            const auto row = store_.row_of(entry.handles[i]);
+                            if (!row) continue;
+
+                            // recorded rows and store rows agree after discard_unrecorded
+                            shadow[*row] = previous[i];
+                            store_.set_value(*row, track.slot, to_property_value(previous[i]));
+                        }
+                    },
+                    track.shadow);
+                entry.tick = 0;
+            }
+        }
+
+        tick_ = tick;
+        synced_version_ = store_.version();
+        return true;
+    }
+
+private:
+    template <typename Func>
+    void for_each_dirty_range(Func &&func) const
+    {
+        const size_t rows = store_.size();
+        const auto &versions = store_.chunk_versions();
+        for (size_t chunk = 0; chunk < versions.size(); ++chunk)
+        {
+            const size_t begin = chunk * ObjectStore::version_chunk_rows;
+            if (begin >= rows) break;
+            if (versions[chunk] <= synced_version_) continue;
+
+            func(begin, std::min(rows, begin + ObjectStore::version_chunk_rows));
+        }
+    }
+
+    // appends to this tick's entry every row in [begin, end) whose value
+    // differs from the shadow; rows without a shadow row are new objects
+    void collect_changes(Track &track, const uint64_t tick, const size_t begin, const size_t end,
+                         const std::vector<uint32_t> *shadow_rows)
+    {
+        auto &entry = track.ring[tick % track.ring.size()];
+        std::visit(
+            [&](const auto &shadow)
+            {
+                using Values = std::decay_t<decltype(shadow)>;
+                const auto &current = std::get<Values>(store_.get_column(track.slot));
+                auto &previous = std::get<Values>(entry.previous);
+
+                for (size_t row = begin; row < end; ++row)
+                {
+                    const uint32_t shadow_row = shadow_rows ? (*shadow_rows)[row] : static_cast<uint32_t>(row);
+                    if (shadow_row == UINT32_MAX || current[row] == shadow[shadow_row]) continue;
+
+                    entry.handles.push_back(store_.handle_at(row));
+                    previous.push_back(shadow[shadow_row]);
+                }
+            },
+            track.shadow);
+    }
+
+    void copy_dirty_to_shadow()
+    {
+        for_each_dirty_range(
+            [&](const size_t begin, const size_t end)
+            {
+                for (auto &track : tracks_)
+                {
+                    std::visit(
+                        [&](auto &shadow)
+                        {
+                            const auto &current =
+                                std::get<std::decay_t<decltype(shadow)>>(store_.get_column(track.slot));
+                            std::copy(current.begin() + begin, current.begin() + end, shadow.begin() + begin);
+                        },
+                        track.shadow);
+                }
+            });
+    }
+
+    void rebuild_shadow()
+    {
+        for (auto &track : tracks_)
+        {
+            track.shadow = store_.get_column(track.slot);
+        }
+
+        const size_t rows = store_.size();
+        shadow_handles_.resize(rows);
+        uint32_t max_index = 0;
+        for (size_t row = 0; row < rows; ++row)
+        {
+            shadow_handles_[row] = store_.handle_at(row);
+            max_index = std::max(max_index, shadow_handles_[row].index + 1);
+        }
+
+        shadow_row_of_index_.assign(max_index, UINT32_MAX);
+        for (uint32_t row = 0; row < rows; ++row)
+        {
+            shadow_row_of_index_[shadow_handles_[row].index] = row;
+        }
+
+        synced_version_ = store_.version();
+        synced_structure_ = store_.structure_version();
+    }
+
+    // store row -> shadow row of the same object, UINT32_MAX if it is new
+    [[nodiscard]] std::vector<uint32_t> map_rows_to_shadow() const
+    {
+        std::vector<uint32_t> shadow_rows(store_.size(), UINT32_MAX);
+        for (size_t row = 0; row < shadow_rows.size(); ++row)
+        {
+            const ObjectHandle handle = store_.handle_at(row);
+            if (handle.index >= shadow_row_of_index_.size()) continue;
+
+            const uint32_t shadow_row = shadow_row_of_index_[handle.index];
+            if (shadow_row != UINT32_MAX && shadow_handles_[shadow_row] == handle) shadow_rows[row] = shadow_row;
+        }
+        return shadow_rows;
+    }
+
+    // puts tracked values written since the last record() back to their
+    // recorded state and realigns the shadow with the store's rows
+    void discard_unrecorded()
+    {
+        if (store_.version() == synced_version_) return;
+
+        const bool moved = store_.structure_version() != synced_structure_;
+        const auto shadow_rows = moved ? map_rows_to_shadow() : std::vector<uint32_t>();
+
+        const auto restore = [&](const size_t begin, const size_t end)
+        {
+            for (const auto &track : tracks_)
+            {
+                std::visit(
+                    [&](const auto &shadow)
+                    {
+                        const auto &current = std::get<std::decay_t<decltype(shadow)>>(store_.get_column(track.slot));
+                        for (size_t row = begin; row < end; ++row)
+                        {
+                            const uint32_t shadow_row = moved ? shadow_rows[row] : static_cast<uint32_t>(row);
+                            if (shadow_row == UINT32_MAX || current[row] == shadow[shadow_row]) continue;
+
+                            store_.set_value(row, track.slot, to_property_value(shadow[shadow_row]));
+                        }
+                    },
+                    track.shadow);
+            }
+        };
+
+        if (moved)
+        {
+            restore(0, store_.size());
+            rebuild_shadow();
+        }
+        else
+        {
+            for_each_dirty_range(restore);
+            synced_version_ = store_.version();
+        }
+    }
+};
@@ -0,0 +1,619 @@
+#pragma once
+
+// MessagePack codec bound to registered types.
+//
+// An object is encoded as a map from property name to value, in slot order;
+// a store as an array of such maps. MsgPackCodec resolves a type's layout
+// once: every key is pre-encoded, and decoding maps keys back to slots
+// through hash_name, so neither direction builds a DOM or allocates per
+// field beyond the decoded strings themselves.
+//
+// Value mapping: int -> int family, double -> float64 (float32 and ints are
+// accepted when reading), bool -> bool, string -> str, ref<T> -> fixext 8 of
+// type 1 holding index and generation, nil for a null reference.
+
+#include "reflekt.hpp"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class MsgPackWriter
+{
+private:
+    std::string &out_;
+
+public:
+    static constexpr int8_t handle_ext_type = 1;
+
+    explicit MsgPackWriter(std::string &out) : out_(out) {}
+
+    void nil() { byte(0xc0); }
+    void boolean(const bool value) { byte(value ? 0xc3 : 0xc2); }
+
+    void integer(const int64_t value)
+    {
+        if (value >= 0 && value <= 0x7f)
+        {
+            byte(static_cast<uint8_t>(value));
+        }
+        else if (value < 0 && value >= -32)
+        {
+            byte(static_cast<uint8_t>(static_cast<int8_t>(value)));
+        }
+        else if (value >= INT8_MIN && value <= INT8_MAX)
+        {
+            byte(0xd0);
+            big_endian(static_cast<uint8_t>(static_cast<int8_t>(value)));
+        }
+        else if (value >= INT16_MIN && value <= INT16_MAX)
+        {
+            byte(0xd1);
+            big_endian(static_cast<uint16_t>(static_cast<int16_t>(value)));
+        }
+        else if (value >= INT32_MIN && value <= INT32_MAX)
+        {
+            byte(0xd2);
+            big_endian(static_cast<uint32_t>(static_cast<int32_t>(value)));
+        }
+        else
+        {
+            byte(0xd3);
+            big_endian(static_cast<uint64_t>(value));
+        }
+    }
+
+    void real(const double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        byte(0xcb);
+        big_endian(bits);
+    }
+
+    void string(const std::string_view value)
+    {
+        const size_t size = value.size();
+        if (size <= 31)
+        {
+            byte(static_cast<uint8_t>(0xa0 | size));
+        }
+        else if (size <= UINT8_MAX)
+        {
+            byte(0xd9);
+            big_endian(static_cast<uint8_t>(size));
+        }
+        else if (size <= UINT16_MAX)
+        {
+            byte(0xda);
+            big_endian(static_cast<uint16_t>(size));
+        }
+        else
+        {
+            byte(0xdb);
+            big_endian(static_cast<uint32_t>(size));
+        }
+        out_.append(value.data(), size);
+    }
+
+    void handle(const ObjectHandle value)
+    {
+        if (!value.is_valid())
+        {
+            nil();
+            return;
+        }
+
+        byte(0xd7);
+        byte(static_cast<uint8_t>(handle_ext_type));
+        big_endian(value.index);
+        big_endian(value.generation);
+    }
+
+    void array_header(const uint32_t count) { container_header(count, 0x90, 0xdc, 0xdd); }
+    void map_header(const uint32_t count) { container_header(count, 0x80, 0xde, 0xdf); }
+
+    // pre-encoded bytes, e.g. a key resolved once per type
+    void raw(const std::string_view bytes) { out_.append(bytes.data(), bytes.size()); }
+
+private:
+    void byte(const uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    template <typename T>
+    void big_endian(const T value)
+    {
+        for (size_t shift = sizeof(T) * 8; shift > 0; shift -= 8)
+        {
+            byte(static_cast<uint8_t>(value >> (shift - 8)));
+        }
+    }
+
+    void container_header(const uint32_t count, const uint8_t fix, const uint8_t wide16, const uint8_t wide32)
+    {
+        if (count <= 15)
+        {
+            byte(static_cast<uint8_t>(fix | count));
+        }
+        else if (count <= UINT16_MAX)
+        {
+            byte(wide16);
+            big_endian(static_cast<uint16_t>(count));
+        }
+        else
+        {
+            byte(wide32);
+            big_endian(count);
+        }
+    }
+};
+
+// sequential reader over a complete buffer; a read returns nullopt without
+// consuming anything when the next value has a different type
+class MsgPackReader
+{
+private:
+    const uint8_t *cursor_;
+    const uint8_t *end_;
+
+public:
+    explicit MsgPackReader(const std::string_view buffer) :
+        cursor_(reinterpret_cast<const uint8_t *>(buffer.data())), end_(cursor_ + buffer.size())
+    {
+    }
+
+    [[nodiscard]] bool at_end() const { return cursor_ >= end_; }
+    [[nodiscard]] size_t remaining() const { return static_cast<size_t>(end_ - cursor_); }
+
+    bool nil()
+    {
+        if (at_end() || *cursor_ != 0xc0) return false;
+
+        ++cursor_;
+        return true;
+    }
+
+    std::optional<bool> boolean()
+    {
+        if (at_end() || (*cursor_ != 0xc2 && *cursor_ != 0xc3)) return std::nullopt;
+
+        return *cursor_++ == 0xc3;
+    }
+
+    std::optional<int64_t> integer()
+    {
+        if (at_end()) return std::nullopt;
+
+        const uint8_t tag = *cursor_;
+        if (tag <= 0x7f || tag >= 0xe0)
+        {
+            ++cursor_;
+            return static_cast<int64_t>(static_cast<int8_t>(tag));
+        }
+
+        const auto width = [tag]() -> size_t
+        {
+            switch (tag)
+            {
+            case 0xcc:
+            case 0xd0:
+                return 1;
+            case 0xcd:
+            case 0xd1:
+                return 2;
+            case 0xce:
+            case 0xd2:
+                return 4;
+            case 0xcf:
+            case 0xd3:
+                return 8;
+            default:
+                return 0;
+            }
+        }();
+        if (width == 0 || remaining() < 1 + width) return std::nullopt;
+
+        ++cursor_;
+        const uint64_t bits = read_big_endian(width);
+        if (tag >= 0xd0)
+        {
+            // sign-extend from the encoded width
+            const unsigned shift = static_cast<unsigned>(64 - width * 8);
+            return static_cast<int64_t>(bits << shift) >> shift;
+        }
+        return static_cast<int64_t>(bits);
+    }
+
+    // floats of either width; integers are widened
+    std::optional<double> real()
+    {
+        if (at_end()) return std::nullopt;
+
+        if (*cursor_ == 0xcb && remaining() >= 9)
+        {
+            ++cursor_;
+            const uint64_t bits = read_big_endian(8);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        if (*cursor_ == 0xca && remaining() >= 5)
+        {
+            ++cursor_;
+            const auto bits = static_cast<uint32_t>(read_big_endian(4));
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        const auto value = integer();
+        return value ? std::optional<double>(static_cast<double>(*value)) : std::nullopt;
+    }
+
+    // view into the buffer; no copy
+    std::optional<std::string_view> string()
+    {
+        if (at_end()) return std::nullopt;
+
+        const uint8_t tag = *cursor_;
+        size_t header = 1;
+        size_t size = 0;
+        if ((tag & 0xe0) == 0xa0)
+        {
+            size = tag & 0x1f;
+        }
+        else if (tag >= 0xd9 && tag <= 0xdb)
+        {
+            const size_t width = size_t{1} << (tag - 0xd9);
+            if (remaining() < 1 + width) return std::nullopt;
+
+            for (size_t i = 0; i < width; ++i)
+            {
+                size = (size << 8) | cursor_[1 + i];
+            }
+            header += width;
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        if (remaining() - header < size) return std::nullopt;
+
+        cursor_ += header;
+        const std::string_view value(reinterpret_cast<const char *>(cursor_), size);
+        cursor_ += size;
+        return value;
+    }
+
+    // nil reads as the null handle
+    std::optional<ObjectHandle> handle()
+    {
+        if (nil()) return ObjectHandle();
+        if (remaining() < 10 || cursor_[0] != 0xd7 || static_cast<int8_t>(cursor_[1]) != MsgPackWriter::handle_ext_type)
+        {
+            return std::nullopt;
+        }
+
+        cursor_ += 2;
+        ObjectHandle value;
+        value.index = static_cast<uint32_t>(read_big_endian(4));
+        value.generation = static_cast<uint32_t>(read_big_endian(4));
+        return value;
+    }
+
+    std::optional<uint32_t> array_header() { return container_header(0x90, 0xdc, 0xdd); }
+    std::optional<uint32_t> map_header() { return container_header(0x80, 0xde, 0xdf); }
+
+    // steps over one complete value of any type; false on malformed input
+    bool skip()
+    {
+        if (at_end()) return false;
+
+        const uint8_t tag = *cursor_;
+        if (tag <= 0x7f || tag >= 0xe0 || tag == 0xc0 || tag == 0xc2 || tag == 0xc3) return advance(1);
+        if ((tag & 0xe0) == 0xa0 || (tag >= 0xd9 && tag <= 0xdb)) return string().has_value();
+        if (tag >= 0xcc && tag <= 0xd3) return integer().has_value();
+        if (tag == 0xca || tag == 0xcb) return real().has_value();
+
+        // bin 8/16/32 and ext 8/16/32: length-prefixed payloads
+        if (tag >= 0xc4 && tag <= 0xc6) return skip_sized(size_t{1} << (tag - 0xc4), 0);
+        if (tag >= 0xc7 && tag <= 0xc9) return skip_sized(size_t{1} << (tag - 0xc7), 1);
+        if (tag >= 0xd4 && tag <= 0xd8) return advance(2 + (size_t{1} << (tag - 0xd4)));
+
+        const bool is_map = (tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf;
+        const auto count = is_map ? map_header() : array_header();
+        if (!count) return false;
+
+        const uint64_t values = is_map ? uint64_t{*count} * 2 : *count;
+        for (uint64_t i = 0; i < values; ++i)
+        {
+            if (!skip()) return false;
+        }
+        return true;
+    }
+
+private:
+    uint64_t read_big_endian(const size_t width)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < width; ++i)
+        {
+            value = (value << 8) | *cursor_++;
+        }
+        return value;
+    }
+
+    bool advance(const size_t bytes)
+    {
+        if (remaining() < bytes) return false;
+
+        cursor_ += bytes;
+        return true;
+    }
+
+    bool skip_sized(const size_t width, const size_t extra)
+    {
+        if (remaining() < 1 + width) return false;
+
+        ++cursor_;
+        const auto size = static_cast<size_t>(read_big_endian(width));
+        return advance(extra + size);
+    }
+
+    std::optional<uint32_t> container_header(const uint8_t fix, const uint8_t wide16, const uint8_t wide32)
+    {
+        if (at_end()) return std::nullopt;
+
+        const uint8_t tag = *cursor_;
+        if ((tag & 0xf0) == fix)
+        {
+            ++cursor_;
+            return tag & 0x0f;
+        }
+
+        const size_t width = tag == wide16 ? 2 : tag == wide32 ? 4 : 0;
+        if (width == 0 || remaining() < 1 + width) return std::nullopt;
+
+        ++cursor_;
+        return static_cast<uint32_t>(read_big_endian(width));
+    }
+};
+
+class MsgPackCodec
+{
+private:
+    struct Field
+    {
+        size_t slot;
+        std::string name;
+        ValueKind kind;
+        PropertyKey key;
+        std::string encoded_key;
+    };
+
+    std::string type_name_;
+    std::vector<Field> fields_;
+    std::unordered_map<uint64_t, size_t, KeyHash> field_by_key_;
+
+    MsgPackCodec() = default;
+
+public:
+    // nullopt if the type is not registered. `required`/`excluded` restrict
+    // the codec to slots by attribute, e.g. Replicated for a network
+    // snapshot; keys outside the subset are skipped when decoding.
+    [[nodiscard]] static std::optional<MsgPackCodec> for_type(const std::string &type_name,
+                                                              const uint32_t required = PropertyAttributes::None,
+                                                              const uint32_t excluded = PropertyAttributes::None)
+    {
+        if (!TypeRegistry::instance().get_type(type_name)) return std::nullopt;
+
+        MsgPackCodec codec;
+        codec.type_name_ = type_name;
+        const auto layout = TypeRegistry::instance().get_all_properties(type_name);
+        for (const size_t slot : select_slots(layout, required, excluded))
+        {
+            const auto &prop = layout[slot];
+            Field field{slot, prop.name, value_kind_for(prop), PropertyKey(prop.name), {}};
+            MsgPackWriter(field.encoded_key).string(prop.name);
+
+            codec.field_by_key_[field.key.hash] = codec.fields_.size();
+            codec.fields_.push_back(std::move(field));
+        }
+        return codec;
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+
+    // slots of `store` must come from this codec's type
+    [[nodiscard]] bool matches(const ObjectStore &store) const { return store.get_type_name() == type_name_; }
+
+    void encode(const ObjectStore &store, const size_t row, MsgPackWriter &out) const
+    {
+        out.map_header(static_cast<uint32_t>(fields_.size()));
+        for (const auto &field : fields_)
+        {
+            out.raw(field.encoded_key);
+            std::visit([&](const auto &values) { write_element(values[row], out); }, store.get_column(field.slot));
+        }
+    }
+
+    // the whole store as an array of maps, in row order
+    bool encode(const ObjectStore &store, MsgPackWriter &out) const
+    {
+        if (!matches(store)) return false;
+
+        out.array_header(static_cast<uint32_t>(store.size()));
+        for (size_t row = 0; row < store.size(); ++row)
+        {
+            encode(store, row, out);
+        }
+        return true;
+    }
+
+    // resolved values, so a prototype-backed object encodes what it reads as
+    void encode(const DynamicObject &object, MsgPackWriter &out) const
+    {
+        out.map_header(static_cast<uint32_t>(fields_.size()));
+        for (const auto &field : fields_)
+        {
+            out.raw(field.encoded_key);
+            if (const auto value = object.find_property(field.key))
+            {
+                std::visit([&](const auto &v) { write_element(v, out); }, *value);
+            }
+            else
+            {
+                out.nil();
+            }
+        }
+    }
+
+    // one map into a new object; unknown keys are skipped, missing keys keep
+    // their defaults. On malformed input the partial object is destroyed.
+    std::optional<ObjectHandle> decode(MsgPackReader &in, ObjectStore &store) const
+    {
+        if (!matches(store)) return std::nullopt;
+
+        const auto count = in.map_header();
+        if (!count) return std::nullopt;
+
+        const auto handle = store.create();
+        const size_t row = *store.row_of(handle);
+        for (uint32_t i = 0; i < *count; ++i)
+        {
+            const auto field = read_key(in);
+            if (!field)
+            {
+                store.destroy(handle);
+                return std::nullopt;
+            }
+            if (*field == fields_.size())
+            {
+                if (in.skip()) continue;
+
+                store.destroy(handle);
+                return std::nullopt;
+            }
+
+            auto value = read_value(in, fields_[*field].kind);
+            if (!value || !store.set_value(row, fields_[*field].slot, std::move(*value)))
+            {
+                store.destroy(handle);
+                return std::nullopt;
+            }
+        }
+
+        return handle;
+    }
+
+    // an array of maps; stops at the first malformed entry
+    bool decode_all(MsgPackReader &in, ObjectStore &store) const
+    {
+        const auto count = in.array_header();
+        if (!count || !matches(store)) return false;
+
+        store.reserve(store.size() + *count);
+        for (uint32_t i = 0; i < *count; ++i)
+        {
+            if (!decode(in, store)) return false;
+        }
+        return true;
+    }
+
+    bool decode(MsgPackReader &in, DynamicObject &object) const
+    {
+        const auto count = in.map_header();
+        if (!count) return false;
+
+        for (uint32_t i = 0; i < *count; ++i)
+        {
+            const auto field = read_key(in);
+            if (!field) return false;
+            if (*field == fields_.size())
+            {
+                if (!in.skip()) return false;
+                continue;
+            }
+
+            auto value = read_value(in, fields_[*field].kind);
+            if (!value || !object.set_property(fields_[*field].key, *value)) return false;
+        }
+
+        return true;
+    }
+
+private:
+    template <typename T>
+    static void write_element(const T &value, MsgPackWriter &out)
+    {
+        if constexpr (std::is_same_v<T, int>)
+        {
+            out.integer(value);
+        }
+        else if constexpr (std::is_same_v<T, double>)
+        {
+            out.real(value);
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            out.boolean(value);
+        }
+        else if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            out.boolean(value != 0);
+        }
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            out.string(value);
+        }
+        else
+        {
+            out.handle(value);
+        }
+    }
+
+    // field index, fields_.size() for a key this codec does not cover, nullopt
+    // if the key is not a string
+    std::optional<size_t> read_key(MsgPackReader &in) const
+    {
+        const auto key = in.string();
+        if (!key) return std::nullopt;
+
+        const auto it = field_by_key_.find(hash_name(*key));
+        if (it == field_by_key_.end() || fields_[it->second].name != *key) return fields_.size();
+        return it->second;
+    }
+
+    static std::optional<PropertyValue> read_value(MsgPackReader &in, const ValueKind kind)
+    {
+        switch (kind)
+        {
+        case ValueKind::Int:
+            if (const auto value = in.integer())
+            {
+                if (*value < INT_MIN || *value > INT_MAX) return std::nullopt;
+                return PropertyValue(static_cast<int>(*value));
+            }
+            break;
+        case ValueKind::Double:
+            if (const auto value = in.real()) return PropertyValue(*value);
+            break;
+        case ValueKind::Bool:
+            if (const auto value = in.boolean()) return PropertyValue(*value);
+            break;
+        case ValueKind::String:
+            if (const auto value = in.string()) return PropertyValue(std::string(*value));
+            break;
+        case ValueKind::Ref:
+            if (const auto value = in.handle()) return PropertyValue(*value);
+            break;
+        }
+
+        return std::nullopt;
+    }
+};
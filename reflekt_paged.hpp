@@ -0,0 +1,447 @@
+#pragma once
+
+// Object store with a memory budget. Objects live in fixed-size chunks of
+// rows; when the resident chunks exceed the budget, the least recently used
+// ones are written to a spill file (write_binary format) and dropped from
+// memory. Access through a handle faults the chunk back in transparently.
+//
+// Per-object bookkeeping (alive flag and generation) always stays resident,
+// about 8 bytes per object, so handle checks never touch the disk.
+//
+// Spill I/O failures are counted in spill_error_count(). A chunk that cannot
+// be written out stays resident, over budget if need be; an access whose
+// chunk cannot be read back fails like one through a dead handle.
+
+#include "reflekt.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class PagedObjectStore
+{
+private:
+    struct Chunk
+    {
+        std::vector<Column> columns; // empty while spilled
+        size_t bytes = 0;
+        bool dirty = true; // resident copy differs from the spill extent
+        uint64_t file_offset = 0;
+        uint64_t file_size = 0; // 0 = never spilled
+        uint64_t file_capacity = 0;
+        std::list<uint32_t>::iterator lru_position;
+    };
+
+    struct HandleSlot
+    {
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::string type_name_;
+    std::vector<PropertyDescriptor> layout_;
+    std::unordered_map<std::string, size_t> slot_index_;
+    size_t chunk_rows_;
+    size_t memory_budget_;
+
+    std::vector<Chunk> chunks_;
+    std::vector<HandleSlot> handle_slots_;
+    std::vector<uint32_t> free_handles_;
+    size_t live_count_ = 0;
+
+    std::list<uint32_t> lru_; // front = most recently used, resident chunks only
+    size_t resident_bytes_ = 0;
+
+    std::string spill_path_;
+    std::fstream spill_;
+    uint64_t spill_end_ = 0;
+    size_t faults_ = 0;
+    size_t evictions_ = 0;
+    size_t spill_errors_ = 0;
+
+    PagedObjectStore(std::string type_name, const size_t memory_budget, const size_t chunk_rows) :
+        type_name_(std::move(type_name)), chunk_rows_(chunk_rows), memory_budget_(memory_budget)
+    {
+        layout_ = TypeRegistry::instance().get_all_properties(type_name_);
+        for (size_t slot = 0; slot < layout_.size(); ++slot)
+        {
+            slot_index_[layout_[slot].name] = slot;
+        }
+    }
+
+public:
+    PagedObjectStore(const PagedObjectStore &) = delete;
+    PagedObjectStore &operator=(const PagedObjectStore &) = delete;
+
+    // the spill file is scratch space and goes away with the store
+    ~PagedObjectStore()
+    {
+        if (spill_.is_open())
+        {
+            spill_.close();
+            std::remove(spill_path_.c_str());
+        }
+    }
+
+    // nullptr if the type is unknown or the spill file cannot be created
+    static std::unique_ptr<PagedObjectStore> create(const std::string &type_name, const std::string &spill_path,
+                                                    const size_t memory_budget, const size_t chunk_rows = 4096)
+    {
+        if (!TypeRegistry::instance().get_type(type_name) || chunk_rows == 0) return nullptr;
+
+        std::unique_ptr<PagedObjectStore> store(new PagedObjectStore(type_name, memory_budget, chunk_rows));
+        store->spill_path_ = spill_path;
+        store->spill_.open(spill_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!store->spill_) return nullptr;
+
+        return store;
+    }
+
+    [[nodiscard]] const std::string &get_type_name() const { return type_name_; }
+    [[nodiscard]] const std::vector<PropertyDescriptor> &get_layout() const { return layout_; }
+    [[nodiscard]] size_t size() const { return live_count_; }
+    [[nodiscard]] size_t resident_bytes() const { return resident_bytes_; }
+    [[nodiscard]] size_t resident_chunks() const { return lru_.size(); }
+    [[nodiscard]] size_t chunk_count() const { return chunks_.size(); }
+    [[nodiscard]] size_t fault_count() const { return faults_; }
+    [[nodiscard]] size_t eviction_count() const { return evictions_; }
+    [[nodiscard]] size_t spill_error_count() const { return spill_errors_; }
+
+    [[nodiscard]] std::optional<size_t> find_slot(const std::string &name) const
+    {
+        const auto it = slot_index_.find(name);
+        return it != slot_index_.end() ? std::optional<size_t>(it->second) : std::nullopt;
+    }
+
+    // an invalid handle if a recycled row's chunk cannot be read back
+    ObjectHandle create()
+    {
+        uint32_t index;
+        if (!free_handles_.empty())
+        {
+            index = free_handles_.back();
+            free_handles_.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(handle_slots_.size());
+            handle_slots_.emplace_back();
+            if (index / chunk_rows_ >= chunks_.size()) add_chunk();
+        }
+
+        // recycled rows still hold the previous object's values
+        auto *chunk_ptr = touch(index / chunk_rows_);
+        if (!chunk_ptr)
+        {
+            free_handles_.push_back(index);
+            return ObjectHandle();
+        }
+
+        handle_slots_[index].alive = true;
+        ++live_count_;
+
+        auto &chunk = *chunk_ptr;
+        const size_t row = index % chunk_rows_;
+        for (size_t slot = 0; slot < layout_.size(); ++slot)
+        {
+            assign(chunk, slot, row, layout_[slot].default_value);
+        }
+        chunk.dirty = true;
+
+        enforce_budget(index / chunk_rows_);
+        return {index, handle_slots_[index].generation};
+    }
+
+    bool destroy(const ObjectHandle handle)
+    {
+        if (!is_alive(handle)) return false;
+
+        auto &entry = handle_slots_[handle.index];
+        entry.alive = false;
+        ++entry.generation;
+        free_handles_.push_back(handle.index);
+        --live_count_;
+        return true;
+    }
+
+    [[nodiscard]] bool is_alive(const ObjectHandle handle) const
+    {
+        return handle.index < handle_slots_.size() && handle_slots_[handle.index].alive &&
+               handle_slots_[handle.index].generation == handle.generation;
+    }
+
+    // faults the owning chunk in if it was spilled
+    [[nodiscard]] PropertyValue get_value(const ObjectHandle handle, const size_t slot)
+    {
+        if (!is_alive(handle) || slot >= layout_.size()) return PropertyValue();
+
+        const size_t chunk_index = handle.index / chunk_rows_;
+        const auto *chunk = touch(chunk_index);
+        if (!chunk) return PropertyValue();
+
+        const size_t row = handle.index % chunk_rows_;
+        auto value = std::visit([row](const auto &values) { return to_property_value(values[row]); },
+                                chunk->columns[slot]);
+
+        enforce_budget(chunk_index);
+        return value;
+    }
+
+    bool set_value(const ObjectHandle handle, const size_t slot, const PropertyValue &value)
+    {
+        if (!is_alive(handle) || slot >= layout_.size()) return false;
+
+        const size_t chunk_index = handle.index / chunk_rows_;
+        auto *chunk = touch(chunk_index);
+        if (!chunk || chunk->columns[slot].index() != value.index()) return false;
+
+        assign(*chunk, slot, handle.index % chunk_rows_, value);
+        chunk->dirty = true;
+
+        enforce_budget(chunk_index);
+        return true;
+    }
+
+    template <typename T>
+    bool set_property(const ObjectHandle handle, const std::string &name, const T &value)
+    {
+        const auto slot = find_slot(name);
+        return slot && set_value(handle, *slot, PropertyValue(value));
+    }
+
+    template <typename T>
+    [[nodiscard]] std::optional<T> get_property(const ObjectHandle handle, const std::string &name)
+    {
+        const auto slot = find_slot(name);
+        if (!slot || !is_alive(handle)) return std::nullopt;
+
+        const auto value = get_value(handle, *slot);
+        if (std::holds_alternative<T>(value))
+        {
+            return std::get<T>(value);
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    void add_chunk()
+    {
+        auto &chunk = chunks_.emplace_back();
+        for (const auto &prop : layout_)
+        {
+            chunk.columns.push_back(make_column(value_kind_for(prop)));
+            std::visit([this](auto &values) { values.resize(chunk_rows_); }, chunk.columns.back());
+        }
+
+        chunk.bytes = measure(chunk);
+        resident_bytes_ += chunk.bytes;
+        lru_.push_front(static_cast<uint32_t>(chunks_.size() - 1));
+        chunk.lru_position = lru_.begin();
+    }
+
+    // nullptr if the chunk was spilled and cannot be read back
+    Chunk *touch(const size_t chunk_index)
+    {
+        auto &chunk = chunks_[chunk_index];
+        if (chunk.columns.empty())
+        {
+            if (!fault_in(chunk)) return nullptr;
+            lru_.push_front(static_cast<uint32_t>(chunk_index));
+            chunk.lru_position = lru_.begin();
+        }
+        else if (chunk.lru_position != lru_.begin())
+        {
+            lru_.splice(lru_.begin(), lru_, chunk.lru_position);
+        }
+
+        return &chunk;
+    }
+
+    // never evicts `keep`, the chunk the caller is working on. Stops at the
+    // first chunk that cannot be written; the next call tries again.
+    void enforce_budget(const size_t keep)
+    {
+        while (resident_bytes_ > memory_budget_ && lru_.size() > 1)
+        {
+            const uint32_t victim = lru_.back() == keep ? *std::next(lru_.rbegin()) : lru_.back();
+            if (!evict(victim)) break;
+        }
+    }
+
+    // false, with the chunk left resident and dirty, if its image could not
+    // be written to the spill file
+    bool evict(const uint32_t chunk_index)
+    {
+        auto &chunk = chunks_[chunk_index];
+        if (chunk.dirty)
+        {
+            std::string bytes;
+            bytes.reserve(chunk.bytes);
+            for (const auto &column : chunk.columns)
+            {
+                std::visit(
+                    [&bytes](const auto &values)
+                    {
+                        using Elem = typename std::decay_t<decltype(values)>::value_type;
+                        if constexpr (std::is_same_v<Elem, std::string>)
+                        {
+                            for (const auto &value : values)
+                            {
+                                write_binary(bytes, value);
+                            }
+                        }
+                        else
+                        {
+                            bytes.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(Elem));
+                        }
+                    },
+                    column);
+            }
+
+            // reuse the chunk's previous extent when the new image fits
+            const bool grows = bytes.size() > chunk.file_capacity;
+            const uint64_t offset = grows ? spill_end_ : chunk.file_offset;
+
+            spill_.clear();
+            spill_.seekp(static_cast<std::streamoff>(offset));
+            spill_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            spill_.flush();
+            if (!spill_)
+            {
+                ++spill_errors_;
+                return false;
+            }
+
+            if (grows)
+            {
+                chunk.file_offset = offset;
+                chunk.file_capacity = bytes.size();
+                spill_end_ += bytes.size();
+            }
+            chunk.file_size = bytes.size();
+        }
+
+        resident_bytes_ -= chunk.bytes;
+        chunk.columns.clear();
+        chunk.columns.shrink_to_fit();
+        lru_.erase(chunk.lru_position);
+        ++evictions_;
+        return true;
+    }
+
+    // false, with the chunk left spilled, on a failed or short read or an
+    // image that does not decode
+    bool fault_in(Chunk &chunk)
+    {
+        std::string bytes(chunk.file_size, '\0');
+        spill_.clear();
+        spill_.seekg(static_cast<std::streamoff>(chunk.file_offset));
+        spill_.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!spill_ || spill_.gcount() != static_cast<std::streamsize>(bytes.size()))
+        {
+            ++spill_errors_;
+            return false;
+        }
+
+        const char *cursor = bytes.data();
+        const char *end = bytes.data() + bytes.size();
+        bool decoded = true;
+        std::vector<Column> columns;
+        for (const auto &prop : layout_)
+        {
+            columns.push_back(make_column(value_kind_for(prop)));
+            std::visit(
+                [&](auto &values)
+                {
+                    using Elem = typename std::decay_t<decltype(values)>::value_type;
+                    values.resize(chunk_rows_);
+                    if constexpr (std::is_same_v<Elem, std::string>)
+                    {
+                        for (auto &value : values)
+                        {
+                            decoded = decoded && read_binary(cursor, end, value);
+                        }
+                    }
+                    else
+                    {
+                        const size_t size = values.size() * sizeof(Elem);
+                        if (size > static_cast<size_t>(end - cursor))
+                        {
+                            decoded = false;
+                            return;
+                        }
+                        std::memcpy(values.data(), cursor, size);
+                        cursor += size;
+                    }
+                },
+                columns.back());
+        }
+        if (!decoded)
+        {
+            ++spill_errors_;
+            return false;
+        }
+
+        chunk.columns = std::move(columns);
+        chunk.bytes = measure(chunk);
+        chunk.dirty = false;
+        resident_bytes_ += chunk.bytes;
+        ++faults_;
+        return true;
+    }
+
+    void assign(Chunk &chunk, const size_t slot, const size_t row, const PropertyValue &value)
+    {
+        std::visit(
+            [&](auto &values)
+            {
+                using Elem = typename std::decay_t<decltype(values)>::value_type;
+                if constexpr (std::is_same_v<Elem, uint8_t>)
+                {
+                    values[row] = std::holds_alternative<bool>(value) && std::get<bool>(value) ? 1 : 0;
+                }
+                else if constexpr (std::is_same_v<Elem, std::string>)
+                {
+                    const size_t before = values[row].capacity();
+                    values[row] = std::holds_alternative<Elem>(value) ? std::get<Elem>(value) : Elem();
+                    chunk.bytes += values[row].capacity() - before;
+                    resident_bytes_ += values[row].capacity() - before;
+                }
+                else
+                {
+                    values[row] = std::holds_alternative<Elem>(value) ? std::get<Elem>(value) : Elem();
+                }
+            },
+            chunk.columns[slot]);
+    }
+
+    // column storage plus heap-allocated string bodies
+    static size_t measure(const Chunk &chunk)
+    {
+        size_t bytes = 0;
+        for (const auto &column : chunk.columns)
+        {
+            std::visit(
+                [&bytes](const auto &values)
+                {
+                    using Elem = typename std::decay_t<decltype(values)>::value_type;
+                    bytes += values.capacity() * sizeof(Elem);
+                    if constexpr (std::is_same_v<Elem, std::string>)
+                    {
+                        for (const auto &value : values)
+                        {
+                            bytes += value.capacity();
+                        }
+                    }
+                },
+                column);
+        }
+
+        return bytes;
+    }
+};
@@ -0,0 +1,578 @@
+#pragma once
+
+// Data-driven overrides ("patches") applied to object stores in bulk.
+//
+// One patch per line:
+//
+//   Weapon where magical == true: damage *= 1.2
+//   Weapon where level >= 10 and name != "Stick": damage += 5, rare = true
+//
+// The type also selects stores of derived types. Conditions compare a
+// property with a literal (== != < <= > >=; only == and != for bool and
+// string) and are joined by "and". Operations are = for every kind, and
+// += -= *= for int and double; int results are rounded to nearest and
+// saturate at the int range, and a NaN result leaves an int unchanged.
+// Blank lines and lines starting with '#' are skipped.
+//
+// Patches run in ascending priority, then in load order, and each one sees
+// the results of the ones before it: for the same value the last "=" wins
+// and arithmetic composes in that order. apply() keeps that order per row
+// while processing blocks of rows with every patch in turn, so each block
+// is loaded once and the rows are spread across workers.
+
+#include "reflekt.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PatchLoadResult
+{
+    bool ok = false;
+    size_t patches = 0;
+    size_t error_line = 0; // 1-based line that failed to parse; nothing is added then
+};
+
+struct PatchApplyResult
+{
+    size_t patches = 0;        // patch/store pairs that ran
+    size_t values_written = 0; // values that matched a selector, counted once per operation
+};
+
+class PatchSet
+{
+private:
+    enum class CompareOp : uint8_t
+    {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+    };
+
+    enum class WriteOp : uint8_t
+    {
+        Assign,
+        Add,
+        Subtract,
+        Multiply,
+    };
+
+    // the literal is already of the property's kind, with numbers as double
+    struct Condition
+    {
+        std::string property;
+        CompareOp op;
+        PropertyValue literal;
+    };
+
+    struct Operation
+    {
+        std::string property;
+        WriteOp op;
+        PropertyValue literal;
+    };
+
+    struct Patch
+    {
+        std::string type_name;
+        std::vector<Condition> conditions;
+        std::vector<Operation> operations;
+        int priority = 0;
+    };
+
+    // a patch with its properties resolved to one store's slots
+    struct BoundCondition
+    {
+        size_t slot;
+        CompareOp op;
+        const PropertyValue *literal;
+    };
+
+    struct BoundOperation
+    {
+        size_t slot;
+        WriteOp op;
+        const PropertyValue *literal;
+    };
+
+    struct BoundPatch
+    {
+        std::vector<BoundCondition> conditions;
+        std::vector<BoundOperation> operations;
+    };
+
+    static constexpr size_t block_rows = 256;
+
+    std::vector<Patch> patches_;
+
+public:
+    [[nodiscard]] size_t size() const { return patches_.size(); }
+
+    // parses a patch file. Types and properties must be registered; the
+    // whole file is rejected if any line fails.
+    PatchLoadResult load(const std::string_view content, const int priority = 0)
+    {
+        PatchLoadResult result;
+        std::vector<Patch> parsed;
+
+        size_t line_number = 0;
+        size_t pos = 0;
+        while (pos < content.size())
+        {
+            size_t line_end = content.find('\n', pos);
+            if (line_end == std::string_view::npos) line_end = content.size();
+            const auto line = content.substr(pos, line_end - pos);
+            pos = line_end + 1;
+            ++line_number;
+
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos || line[first] == '#') continue;
+
+            auto patch = parse_patch(line);
+            if (!patch)
+            {
+                result.error_line = line_number;
+                return result;
+            }
+            patch->priority = priority;
+            parsed.push_back(std::move(*patch));
+        }
+
+        result.ok = true;
+        result.patches = parsed.size();
+        patches_.insert(patches_.end(), std::make_move_iterator(parsed.begin()), std::make_move_iterator(parsed.end()));
+        return result;
+    }
+
+    PatchApplyResult apply(ObjectStore &store) const
+    {
+        PatchApplyResult result;
+
+        const auto order = ordered_patches();
+        std::vector<BoundPatch> bound;
+        for (const Patch *patch : order)
+        {
+            if (auto resolved = bind(*patch, store)) bound.push_back(std::move(*resolved));
+        }
+        result.patches = bound.size();
+        if (bound.empty() || store.size() == 0) return result;
+
+        // workers own whole version chunks, so they can flag the chunks they
+        // wrote without sharing a byte
+        const size_t chunk_rows = ObjectStore::version_chunk_rows;
+        const size_t rows = store.size();
+        const size_t chunk_count = (rows + chunk_rows - 1) / chunk_rows;
+        const size_t workers = std::min(parallel_chunk_count(rows), chunk_count);
+
+        std::vector<uint8_t> written_chunks(chunk_count, 0);
+        std::vector<size_t> written_values(workers, 0);
+        parallel_for_chunks(chunk_count, workers,
+                            [&](const size_t worker, const size_t begin, const size_t end)
+                            {
+                                std::vector<uint8_t> mask(block_rows);
+                                for (size_t chunk = begin; chunk < end; ++chunk)
+                                {
+                                    const size_t first = chunk * chunk_rows;
+                                    const size_t last = std::min(rows, first + chunk_rows);
+                                    for (size_t block = first; block < last; block += block_rows)
+                                    {
+                                        const size_t count = std::min(last, block + block_rows) - block;
+                                        const size_t matched = apply_block(store, bound, block, count, mask);
+                                        written_values[worker] += matched;
+                                        if (matched) written_chunks[chunk] = 1;
+                                    }
+                                }
+                            });
+
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+        {
+            if (written_chunks[chunk]) store.mark_written(chunk * chunk_rows, (chunk + 1) * chunk_rows);
+        }
+        for (const size_t values : written_values)
+        {
+            result.values_written += values;
+        }
+        return result;
+    }
+
+    PatchApplyResult apply(const std::vector<ObjectStore *> &stores) const
+    {
+        PatchApplyResult result;
+        for (auto *store : stores)
+        {
+            const auto applied = apply(*store);
+            result.patches += applied.patches;
+            result.values_written += applied.values_written;
+        }
+        return result;
+    }
+
+private:
+    // stable: equal priorities keep load order
+    [[nodiscard]] std::vector<const Patch *> ordered_patches() const
+    {
+        std::vector<const Patch *> order;
+        order.reserve(patches_.size());
+        for (const auto &patch : patches_)
+        {
+            order.push_back(&patch);
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [](const Patch *a, const Patch *b) { return a->priority < b->priority; });
+        return order;
+    }
+
+    // nullopt when the patch does not apply to this store's type
+    [[nodiscard]] static std::optional<BoundPatch> bind(const Patch &patch, const ObjectStore &store)
+    {
+        if (!TypeRegistry::instance().is_derived_from(store.get_type_name(), patch.type_name)) return std::nullopt;
+
+        BoundPatch bound;
+        for (const auto &condition : patch.conditions)
+        {
+            const auto slot = store.find_slot(condition.property);
+            if (!slot) return std::nullopt;
+            bound.conditions.push_back({*slot, condition.op, &condition.literal});
+        }
+        for (const auto &operation : patch.operations)
+        {
+            const auto slot = store.find_slot(operation.property);
+            if (!slot) return std::nullopt;
+            bound.operations.push_back({*slot, operation.op, &operation.literal});
+        }
+        return bound;
+    }
+
+    // runs every patch over rows [block, block + count) in order; returns
+    // the number of values written
+    static size_t apply_block(ObjectStore &store, const std::vector<BoundPatch> &patches, const size_t block,
+                              const size_t count, std::vector<uint8_t> &mask)
+    {
+        size_t written = 0;
+        for (const auto &patch : patches)
+        {
+            std::fill(mask.begin(), mask.begin() + count, 1);
+            for (const auto &condition : patch.conditions)
+            {
+                std::visit([&](const auto &values) { select(values.data() + block, count, condition, mask); },
+                           store.get_column(condition.slot));
+            }
+
+            size_t matched = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                matched += mask[i];
+            }
+            if (!matched) continue;
+
+            for (const auto &operation : patch.operations)
+            {
+                std::visit([&](auto &values) { write(values.data() + block, count, operation, mask); },
+                           store.get_column_for_write(operation.slot));
+                written += matched;
+            }
+        }
+        return written;
+    }
+
+    template <typename T, typename U>
+    static bool compare(const T &value, const CompareOp op, const U &literal)
+    {
+        switch (op)
+        {
+        case CompareOp::Equal: return value == literal;
+        case CompareOp::NotEqual: return value != literal;
+        case CompareOp::Less: return value < literal;
+        case CompareOp::LessEqual: return value <= literal;
+        case CompareOp::Greater: return value > literal;
+        case CompareOp::GreaterEqual: return value >= literal;
+        }
+        return false;
+    }
+
+    template <typename Elem>
+    static void select(const Elem *values, const size_t count, const BoundCondition &condition,
+                       std::vector<uint8_t> &mask)
+    {
+        if constexpr (std::is_same_v<Elem, int> || std::is_same_v<Elem, double>)
+        {
+            const double literal = std::get<double>(*condition.literal);
+            // one loop per operator keeps the comparison out of the loop body
+            const auto narrow = [&](auto &&test)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    mask[i] &= static_cast<uint8_t>(test(static_cast<double>(values[i])));
+                }
+            };
+            switch (condition.op)
+            {
+            case CompareOp::Equal: narrow([literal](const double v) { return v == literal; }); break;
+            case CompareOp::NotEqual: narrow([literal](const double v) { return v != literal; }); break;
+            case CompareOp::Less: narrow([literal](const double v) { return v < literal; }); break;
+            case CompareOp::LessEqual: narrow([literal](const double v) { return v <= literal; }); break;
+            case CompareOp::Greater: narrow([literal](const double v) { return v > literal; }); break;
+            case CompareOp::GreaterEqual: narrow([literal](const double v) { return v >= literal; }); break;
+            }
+        }
+        else if constexpr (std::is_same_v<Elem, uint8_t>)
+        {
+            const uint8_t literal = std::get<bool>(*condition.literal) ? 1 : 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                mask[i] &= static_cast<uint8_t>(compare(values[i], condition.op, literal));
+            }
+        }
+        else if constexpr (std::is_same_v<Elem, std::string>)
+        {
+            const auto &literal = std::get<std::string>(*condition.literal);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (mask[i]) mask[i] = static_cast<uint8_t>(compare(values[i], condition.op, literal));
+            }
+        }
+        else
+        {
+            // parse_patch only accepts conditions on the kinds above
+            std::fill(mask.begin(), mask.begin() + count, 0);
+        }
+    }
+
+    static double combine(const double value, const WriteOp op, const double literal)
+    {
+        switch (op)
+        {
+        case WriteOp::Assign: return literal;
+        case WriteOp::Add: return value + literal;
+        case WriteOp::Subtract: return value - literal;
+        case WriteOp::Multiply: return value * literal;
+        }
+        return value;
+    }
+
+    static int round_to_int(const double result, const int previous)
+    {
+        if (std::isnan(result)) return previous;
+
+        constexpr double low = std::numeric_limits<int>::min();
+        constexpr double high = std::numeric_limits<int>::max();
+        return static_cast<int>(std::lround(std::clamp(result, low, high)));
+    }
+
+    template <typename Elem>
+    static void write(Elem *values, const size_t count, const BoundOperation &operation,
+                      const std::vector<uint8_t> &mask)
+    {
+        if constexpr (std::is_same_v<Elem, double>)
+        {
+            const double literal = std::get<double>(*operation.literal);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const double next = combine(values[i], operation.op, literal);
+                values[i] = mask[i] ? next : values[i];
+            }
+        }
+        else if constexpr (std::is_same_v<Elem, int>)
+        {
+            const double literal = std::get<double>(*operation.literal);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (mask[i]) values[i] = round_to_int(combine(values[i], operation.op, literal), values[i]);
+            }
+        }
+        else if constexpr (std::is_same_v<Elem, uint8_t>)
+        {
+            const uint8_t literal = std::get<bool>(*operation.literal) ? 1 : 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                values[i] = mask[i] ? literal : values[i];
+            }
+        }
+        else if constexpr (std::is_same_v<Elem, std::string>)
+        {
+            const auto &literal = std::get<std::string>(*operation.literal);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (mask[i]) values[i] = literal;
+            }
+        }
+    }
+
+    // tokens: identifiers/numbers, "quoted strings", operators, ':' and ','
+    struct Token
+    {
+        std::string text;
+        bool quoted = false;
+    };
+
+    [[nodiscard]] static std::optional<std::vector<Token>> tokenize(const std::string_view line)
+    {
+        std::vector<Token> tokens;
+        size_t pos = 0;
+        while (pos < line.size())
+        {
+            const char c = line[pos];
+            if (c == ' ' || c == '\t' || c == '\r')
+            {
+                ++pos;
+            }
+            else if (c == '"')
+            {
+                const size_t close = line.find('"', pos + 1);
+                if (close == std::string_view::npos) return std::nullopt;
+                tokens.push_back({std::string(line.substr(pos + 1, close - pos - 1)), true});
+                pos = close + 1;
+            }
+            else if (c == ':' || c == ',')
+            {
+                tokens.push_back({std::string(1, c)});
+                ++pos;
+            }
+            else if (std::string_view("=!<>+-*").find(c) != std::string_view::npos &&
+                     !(c == '-' && pos + 1 < line.size() && (std::isdigit(static_cast<unsigned char>(line[pos + 1])) ||
+                                                             line[pos + 1] == '.')))
+            {
+                const bool pair = pos + 1 < line.size() && line[pos + 1] == '=';
+                tokens.push_back({std::string(line.substr(pos, pair ? 2 : 1))});
+                pos += pair ? 2 : 1;
+            }
+            else
+            {
+                const size_t end = line.find_first_of(" \t\r:,=!<>+*\"", pos + 1);
+                const size_t stop = end == std::string_view::npos ? line.size() : end;
+                tokens.push_back({std::string(line.substr(pos, stop - pos))});
+                pos = stop;
+            }
+        }
+        return tokens;
+    }
+
+    // the literal converted for a property of `kind`: numbers as double for
+    // int and double, true/false for bool, any token for string
+    [[nodiscard]] static std::optional<PropertyValue> parse_literal(const Token &token, const ValueKind kind)
+    {
+        switch (kind)
+        {
+        case ValueKind::Int:
+        case ValueKind::Double:
+        {
+            if (token.quoted) return std::nullopt;
+            double number = 0.0;
+            const char *end = token.text.data() + token.text.size();
+            const auto [ptr, ec] = std::from_chars(token.text.data(), end, number);
+            if (ec != std::errc() || ptr != end) return std::nullopt;
+            return PropertyValue(number);
+        }
+        case ValueKind::Bool:
+            if (token.quoted || (token.text != "true" && token.text != "false")) return std::nullopt;
+            return PropertyValue(token.text == "true");
+        case ValueKind::String: return PropertyValue(token.text);
+        case ValueKind::Ref: return std::nullopt;
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] static std::optional<Patch> parse_patch(const std::string_view line)
+    {
+        const auto tokens = tokenize(line);
+        if (!tokens || tokens->empty() || (*tokens)[0].quoted) return std::nullopt;
+
+        Patch patch;
+        patch.type_name = (*tokens)[0].text;
+        const auto layout = TypeRegistry::instance().get_all_properties(patch.type_name);
+        if (layout.empty()) return std::nullopt;
+
+        const auto kind_of = [&layout](const Token &name) -> std::optional<ValueKind>
+        {
+            for (const auto &prop : layout)
+            {
+                if (!name.quoted && prop.name == name.text) return value_kind_for(prop);
+            }
+            return std::nullopt;
+        };
+
+        size_t pos = 1;
+        const auto at = [&](const size_t i) -> const Token * { return i < tokens->size() ? &(*tokens)[i] : nullptr; };
+
+        if (at(pos) && !at(pos)->quoted && at(pos)->text == "where")
+        {
+            do
+            {
+                ++pos;
+                const Token *name = at(pos);
+                const Token *op = at(pos + 1);
+                const Token *literal = at(pos + 2);
+                if (!name || !op || !literal) return std::nullopt;
+
+                const auto kind = kind_of(*name);
+                const auto compare = compare_op(op->text);
+                if (!kind || !compare) return std::nullopt;
+                if ((*kind == ValueKind::Bool || *kind == ValueKind::String) && *compare != CompareOp::Equal &&
+                    *compare != CompareOp::NotEqual)
+                {
+                    return std::nullopt;
+                }
+
+                auto value = parse_literal(*literal, *kind);
+                if (!value) return std::nullopt;
+                patch.conditions.push_back({name->text, *compare, std::move(*value)});
+                pos += 3;
+            } while (at(pos) && !at(pos)->quoted && at(pos)->text == "and");
+        }
+
+        if (!at(pos) || at(pos)->text != ":" || at(pos)->quoted) return std::nullopt;
+
+        do
+        {
+            ++pos;
+            const Token *name = at(pos);
+            const Token *op = at(pos + 1);
+            const Token *literal = at(pos + 2);
+            if (!name || !op || !literal) return std::nullopt;
+
+            const auto kind = kind_of(*name);
+            const auto write = write_op(op->text);
+            if (!kind || !write) return std::nullopt;
+            if ((*kind == ValueKind::Bool || *kind == ValueKind::String) && *write != WriteOp::Assign)
+            {
+                return std::nullopt;
+            }
+
+            auto value = parse_literal(*literal, *kind);
+            if (!value) return std::nullopt;
+            patch.operations.push_back({name->text, *write, std::move(*value)});
+            pos += 3;
+        } while (at(pos) && !at(pos)->quoted && at(pos)->text == ",");
+
+        if (pos != tokens->size()) return std::nullopt;
+        return patch;
+    }
+
+    [[nodiscard]] static std::optional<CompareOp> compare_op(const std::string &text)
+    {
+        if (text == "==") return CompareOp::Equal;
+        if (text == "!=") return CompareOp::NotEqual;
+        if (text == "<") return CompareOp::Less;
+        if (text == "<=") return CompareOp::LessEqual;
+        if (text == ">") return CompareOp::Greater;
+        if (text == ">=") return CompareOp::GreaterEqual;
+        return std::nullopt;
+    }
+
+    [[nodiscard]] static std::optional<WriteOp> write_op(const std::string &text)
+    {
+        if (text == "=") return WriteOp::Assign;
+        if (text == "+=") return WriteOp::Add;
+        if (text == "-=") return WriteOp::Subtract;
+        if (text == "*=") return WriteOp::Multiply;
+        return std::nullopt;
+    }
+};
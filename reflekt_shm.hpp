@@ -0,0 +1,444 @@
+#pragma once
+
+// Shared-memory view of an ObjectStore for local sidecar processes.
+//
+// The simulation keeps writing its ObjectStore as usual and calls
+// SharedStorePublisher::publish at a sync point, which copies the columns
+// into a shm_open/mmap segment in bulk. Readers in other processes map the
+// same segment and read the columns in place. Everything inside the segment
+// is addressed by offsets from its base, so each process can map it at a
+// different address. A seqlock protects readers: a read that overlapped a
+// publish is detected and retried, for a bounded time.
+//
+// POSIX only.
+
+#include "reflekt.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock counter must be usable across processes");
+
+struct SharedStoreHeader
+{
+    static constexpr uint32_t expected_magic = 0x524b5348; // "RKSH"
+    static constexpr uint32_t current_version = 1;
+    static constexpr size_t max_type_name = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint64_t> sequence; // odd while a publish is in progress
+    uint64_t capacity;
+    uint64_t row_count;
+    uint64_t slot_count;
+    uint64_t handles_offset;
+    uint64_t strings_offset;
+    uint64_t strings_capacity;
+    uint64_t segment_size;
+    char type_name[max_type_name];
+};
+
+struct SharedSlotInfo
+{
+    static constexpr size_t max_name = 48;
+
+    char name[max_name];
+    uint32_t kind;
+    uint32_t stride;
+    uint64_t column_offset;
+};
+
+// string columns hold these; the bytes live in the segment's string area
+struct SharedString
+{
+    uint64_t offset;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+// a consistent snapshot is only guaranteed inside SharedStoreReader::read.
+// Rows and string extents are clamped to the segment's capacities, so a read
+// torn by a concurrent publish returns garbage to be retried, never memory
+// outside the segment.
+class SharedStoreView
+{
+private:
+    const char *base_;
+    const SharedStoreHeader *header_;
+    const SharedSlotInfo *slots_;
+
+public:
+    explicit SharedStoreView(const char *base) :
+        base_(base), header_(reinterpret_cast<const SharedStoreHeader *>(base)),
+        slots_(reinterpret_cast<const SharedSlotInfo *>(base + sizeof(SharedStoreHeader)))
+    {
+    }
+
+    [[nodiscard]] std::string_view type_name() const { return header_->type_name; }
+    [[nodiscard]] size_t size() const { return std::min(header_->row_count, header_->capacity); }
+    [[nodiscard]] size_t slot_count() const { return header_->slot_count; }
+    [[nodiscard]] std::string_view slot_name(const size_t slot) const
+    {
+        return slot < header_->slot_count ? slots_[slot].name : std::string_view();
+    }
+    [[nodiscard]] ValueKind slot_kind(const size_t slot) const
+    {
+        return slot < header_->slot_count ? static_cast<ValueKind>(slots_[slot].kind) : ValueKind::Int;
+    }
+
+    [[nodiscard]] std::optional<size_t> find_slot(const std::string_view name) const
+    {
+        for (size_t slot = 0; slot < header_->slot_count; ++slot)
+        {
+            if (name == slots_[slot].name) return slot;
+        }
+
+        return std::nullopt;
+    }
+
+    [[nodiscard]] const ObjectHandle *handles() const
+    {
+        return reinterpret_cast<const ObjectHandle *>(base_ + header_->handles_offset);
+    }
+
+    // int -> int, double -> double, bool -> uint8_t, ref -> ObjectHandle;
+    // nullptr if T does not match the slot
+    template <typename T>
+    [[nodiscard]] const T *column(const size_t slot) const
+    {
+        if (slot >= header_->slot_count || slots_[slot].stride != sizeof(T) ||
+            slots_[slot].kind == static_cast<uint32_t>(ValueKind::String))
+        {
+            return nullptr;
+        }
+
+        return reinterpret_cast<const T *>(base_ + slots_[slot].column_offset);
+    }
+
+    [[nodiscard]] std::string_view string_at(const size_t slot, const size_t row) const
+    {
+        if (slot >= header_->slot_count || row >= header_->capacity ||
+            slots_[slot].kind != static_cast<uint32_t>(ValueKind::String))
+        {
+            return {};
+        }
+
+        const auto &entry = reinterpret_cast<const SharedString *>(base_ + slots_[slot].column_offset)[row];
+        const uint64_t offset = std::min<uint64_t>(entry.offset, header_->strings_capacity);
+        const uint64_t size = std::min<uint64_t>(entry.size, header_->strings_capacity - offset);
+        return {base_ + header_->strings_offset + offset, static_cast<size_t>(size)};
+    }
+};
+
+// owns one mmap'ed range
+struct SharedMapping
+{
+    void *address = MAP_FAILED;
+    size_t size = 0;
+
+    SharedMapping() = default;
+    SharedMapping(const SharedMapping &) = delete;
+    SharedMapping &operator=(const SharedMapping &) = delete;
+
+    ~SharedMapping()
+    {
+        if (address != MAP_FAILED) munmap(address, size);
+    }
+};
+
+class SharedStorePublisher
+{
+private:
+    std::string name_;
+    SharedMapping mapping_;
+    SharedStoreHeader *header_ = nullptr;
+    SharedSlotInfo *slots_ = nullptr;
+
+    SharedStorePublisher() = default;
+
+    // columns start on cache-line boundaries
+    static size_t align_up(const size_t value) { return (value + 63) & ~size_t(63); }
+
+    static uint32_t stride_for(const ValueKind kind)
+    {
+        switch (kind)
+        {
+        case ValueKind::Int:
+            return sizeof(int);
+        case ValueKind::Double:
+            return sizeof(double);
+        case ValueKind::String:
+            return sizeof(SharedString);
+        case ValueKind::Bool:
+            return sizeof(uint8_t);
+        case ValueKind::Ref:
+            return sizeof(ObjectHandle);
+        }
+
+        return 0;
+    }
+
+public:
+    SharedStorePublisher(const SharedStorePublisher &) = delete;
+    SharedStorePublisher &operator=(const SharedStorePublisher &) = delete;
+
+    ~SharedStorePublisher()
+    {
+        if (!name_.empty()) shm_unlink(name_.c_str());
+    }
+
+    // name follows shm_open rules ("/reflekt-players"); the segment is sized
+    // for `capacity` rows and `string_bytes` of string data and removed
+    // again when the publisher is destroyed
+    static std::unique_ptr<SharedStorePublisher> create(const std::string &name, const std::string &type_name,
+                                                        const size_t capacity, const size_t string_bytes = 1 << 20)
+    {
+        const auto layout = TypeRegistry::instance().get_all_properties(type_name);
+        if (!TypeRegistry::instance().get_type(type_name) || type_name.size() >= SharedStoreHeader::max_type_name)
+        {
+            return nullptr;
+        }
+        for (const auto &prop : layout)
+        {
+            if (prop.name.size() >= SharedSlotInfo::max_name) return nullptr;
+        }
+
+        size_t offset = align_up(sizeof(SharedStoreHeader) + layout.size() * sizeof(SharedSlotInfo));
+        const size_t handles_offset = offset;
+        offset = align_up(offset + capacity * sizeof(ObjectHandle));
+
+        std::vector<uint64_t> column_offsets;
+        for (const auto &prop : layout)
+        {
+            column_offsets.push_back(offset);
+            offset = align_up(offset + capacity * stride_for(value_kind_for(prop)));
+        }
+        const size_t strings_offset = offset;
+        const size_t segment_size = align_up(offset + string_bytes);
+
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) return nullptr;
+
+        std::unique_ptr<SharedStorePublisher> publisher(new SharedStorePublisher());
+        publisher->name_ = name;
+
+        if (ftruncate(fd, static_cast<off_t>(segment_size)) != 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+        publisher->mapping_.address = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        publisher->mapping_.size = segment_size;
+        close(fd);
+        if (publisher->mapping_.address == MAP_FAILED) return nullptr;
+
+        auto *base = static_cast<char *>(publisher->mapping_.address);
+        auto *header = new (base) SharedStoreHeader();
+        header->magic = SharedStoreHeader::expected_magic;
+        header->version = SharedStoreHeader::current_version;
+        header->sequence.store(0, std::memory_order_relaxed);
+        header->capacity = capacity;
+        header->row_count = 0;
+        header->slot_count = layout.size();
+        header->handles_offset = handles_offset;
+        header->strings_offset = strings_offset;
+        header->strings_capacity = string_bytes;
+        header->segment_size = segment_size;
+        std::strncpy(header->type_name, type_name.c_str(), SharedStoreHeader::max_type_name - 1);
+
+        auto *slots = reinterpret_cast<SharedSlotInfo *>(base + sizeof(SharedStoreHeader));
+        for (size_t slot = 0; slot < layout.size(); ++slot)
+        {
+            auto *info = new (slots + slot) SharedSlotInfo();
+            std::strncpy(info->name, layout[slot].name.c_str(), SharedSlotInfo::max_name - 1);
+            info->kind = static_cast<uint32_t>(value_kind_for(layout[slot]));
+            info->stride = stride_for(value_kind_for(layout[slot]));
+            info->column_offset = column_offsets[slot];
+        }
+
+        publisher->header_ = header;
+        publisher->slots_ = slots;
+        return publisher;
+    }
+
+    [[nodiscard]] const std::string &get_name() const { return name_; }
+
+    // copies the store into the segment; false if the store is of another
+    // type or does not fit the capacity chosen at create()
+    bool publish(const ObjectStore &store)
+    {
+        if (store.get_type_name() != header_->type_name || store.slot_count() != header_->slot_count ||
+            store.size() > header_->capacity)
+        {
+            return false;
+        }
+
+        size_t string_bytes = 0;
+        for (size_t slot = 0; slot < store.slot_count(); ++slot)
+        {
+            if (const auto *values = std::get_if<std::vector<std::string>>(&store.get_column(slot)))
+            {
+                for (const auto &value : *values)
+                {
+                    string_bytes += value.size();
+                }
+            }
+        }
+        if (string_bytes > header_->strings_capacity) return false;
+
+        auto *base = static_cast<char *>(mapping_.address);
+        const uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+        header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto *handles = reinterpret_cast<ObjectHandle *>(base + header_->handles_offset);
+        for (size_t row = 0; row < store.size(); ++row)
+        {
+            handles[row] = store.handle_at(row);
+        }
+
+        uint64_t string_offset = 0;
+        for (size_t slot = 0; slot < store.slot_count(); ++slot)
+        {
+            char *column = base + slots_[slot].column_offset;
+            std::visit(
+                [&](const auto &values)
+                {
+                    using Elem = typename std::decay_t<decltype(values)>::value_type;
+                    if constexpr (std::is_same_v<Elem, std::string>)
+                    {
+                        auto *entries = reinterpret_cast<SharedString *>(column);
+                        char *strings = base + header_->strings_offset;
+                        for (size_t row = 0; row < values.size(); ++row)
+                        {
+                            std::memcpy(strings + string_offset, values[row].data(), values[row].size());
+                            entries[row] = {string_offset, static_cast<uint32_t>(values[row].size()), 0};
+                            string_offset += values[row].size();
+                        }
+                    }
+                    else if (!values.empty())
+                    {
+                        std::memcpy(column, values.data(), values.size() * sizeof(Elem));
+                    }
+                },
+                store.get_column(slot));
+        }
+
+        header_->row_count = store.size();
+        header_->sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+};
+
+class SharedStoreReader
+{
+private:
+    SharedMapping mapping_;
+
+    SharedStoreReader() = default;
+
+    // every area the view addresses lies inside the segment; the layout is
+    // written once at create(), so this holds for every later snapshot
+    static bool layout_fits(const SharedStoreHeader &header)
+    {
+        const uint64_t size = header.segment_size;
+        const auto fits = [size](const uint64_t offset, const uint64_t count, const uint64_t stride)
+        { return offset <= size && (stride == 0 || count <= (size - offset) / stride); };
+
+        if (!fits(sizeof(SharedStoreHeader), header.slot_count, sizeof(SharedSlotInfo)) ||
+            !fits(header.handles_offset, header.capacity, sizeof(ObjectHandle)) ||
+            !fits(header.strings_offset, header.strings_capacity, 1))
+        {
+            return false;
+        }
+
+        const auto *slots = reinterpret_cast<const SharedSlotInfo *>(reinterpret_cast<const char *>(&header) +
+                                                                     sizeof(SharedStoreHeader));
+        for (size_t slot = 0; slot < header.slot_count; ++slot)
+        {
+            if (!fits(slots[slot].column_offset, header.capacity, slots[slot].stride)) return false;
+        }
+        return true;
+    }
+
+public:
+    SharedStoreReader(const SharedStoreReader &) = delete;
+    SharedStoreReader &operator=(const SharedStoreReader &) = delete;
+
+    static std::unique_ptr<SharedStoreReader> open(const std::string &name)
+    {
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return nullptr;
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedStoreHeader))
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        std::unique_ptr<SharedStoreReader> reader(new SharedStoreReader());
+        reader->mapping_.size = static_cast<size_t>(info.st_size);
+        reader->mapping_.address = mmap(nullptr, reader->mapping_.size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (reader->mapping_.address == MAP_FAILED) return nullptr;
+
+        const auto *header = static_cast<const SharedStoreHeader *>(reader->mapping_.address);
+        if (header->magic != SharedStoreHeader::expected_magic ||
+            header->version != SharedStoreHeader::current_version || header->segment_size != reader->mapping_.size ||
+            !layout_fits(*header))
+        {
+            return nullptr;
+        }
+
+        return reader;
+    }
+
+    // runs `func(const SharedStoreView &)` until it has seen a snapshot no
+    // publish overlapped; func may run more than once, so it should only
+    // read (or restart its own accumulation) and return what it needs.
+    // nullopt if no clean snapshot showed up within `budget`, e.g. because
+    // the publisher died mid-publish and left the sequence odd
+    template <typename Func>
+    auto read(Func &&func, const std::chrono::steady_clock::duration budget = std::chrono::milliseconds(100)) const
+        -> std::optional<std::decay_t<std::invoke_result_t<Func &, const SharedStoreView &>>>
+    {
+        const auto *header = static_cast<const SharedStoreHeader *>(mapping_.address);
+        const SharedStoreView view(static_cast<const char *>(mapping_.address));
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        do
+        {
+            const uint64_t before = header->sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto result = func(view);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header->sequence.load(std::memory_order_relaxed) == before) return result;
+        } while (std::chrono::steady_clock::now() < deadline);
+
+        return std::nullopt;
+    }
+
+    // publish count so far; a cheap "anything new?" check for pollers
+    [[nodiscard]] uint64_t version() const
+    {
+        return static_cast<const SharedStoreHeader *>(mapping_.address)->sequence.load(std::memory_order_acquire) / 2;
+    }
+};
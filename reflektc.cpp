@@ -0,0 +1,519 @@
+// reflektc: compiles DSL type files into a C++ header with native structs,
+// constexpr property tables, slot accessors and binary serializers.
+//
+//   reflektc -o generated.hpp entity.rk player.rk weapon.rk
+//
+// Every base type has to be part of the same invocation.
+
+#include "reflekt.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Options
+{
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+void report_error(const std::string &message) { std::cerr << "reflektc: error: " << message << "\n"; }
+
+std::optional<std::string> read_file(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return std::nullopt;
+
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// keywords and alternative tokens, which cannot name a struct or member
+const std::set<std::string> &cpp_keywords()
+{
+    static const std::set<std::string> keywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+        "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval", "constexpr",
+        "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+        "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+        "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+        "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch",
+        "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+        "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+    };
+    return keywords;
+}
+
+// a name usable as-is in the generated header: not a keyword and not
+// reserved for the implementation (a leading underscore and capital, or a
+// double underscore anywhere)
+bool is_identifier(const std::string &name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) return false;
+    if (!std::all_of(name.begin(), name.end(),
+                     [](const char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }))
+    {
+        return false;
+    }
+
+    if (name.find("__") != std::string::npos) return false;
+    if (name.size() > 1 && name[0] == '_' && std::isupper(static_cast<unsigned char>(name[1]))) return false;
+    return !cpp_keywords().count(name);
+}
+
+// DSL types the generator maps to a C++ member type
+bool is_known_type(const std::string &type_name)
+{
+    return type_name == "int" || type_name == "double" || type_name == "string" || type_name == "bool" ||
+           !reference_target(type_name).empty();
+}
+
+std::string identifier_from_path(const std::string &path)
+{
+    const size_t slash = path.find_last_of("/\\");
+    std::string stem = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    stem = stem.substr(0, stem.find('.'));
+
+    for (auto &c : stem)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c))) c = '_';
+    }
+    if (stem.empty() || std::isdigit(static_cast<unsigned char>(stem[0]))) stem.insert(0, "_");
+    return stem;
+}
+
+const char *cpp_type(const ValueKind kind)
+{
+    switch (kind)
+    {
+    case ValueKind::Int:
+        return "int";
+    case ValueKind::Double:
+        return "double";
+    case ValueKind::String:
+        return "std::string";
+    case ValueKind::Bool:
+        return "bool";
+    case ValueKind::Ref:
+        return "ObjectHandle";
+    }
+
+    return "int";
+}
+
+const char *kind_name(const ValueKind kind)
+{
+    switch (kind)
+    {
+    case ValueKind::Int:
+        return "ValueKind::Int";
+    case ValueKind::Double:
+        return "ValueKind::Double";
+    case ValueKind::String:
+        return "ValueKind::String";
+    case ValueKind::Bool:
+        return "ValueKind::Bool";
+    case ValueKind::Ref:
+        return "ValueKind::Ref";
+    }
+
+    return "ValueKind::Int";
+}
+
+std::string string_literal(const std::string &value)
+{
+    std::ostringstream out;
+    out << '"';
+    for (const char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out << "\\x" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+// infinities and NaN have no literal and are spelled through numeric_limits
+std::string double_literal(const double number)
+{
+    if (std::isnan(number)) return "std::numeric_limits<double>::quiet_NaN()";
+    if (std::isinf(number))
+    {
+        return number < 0 ? "-std::numeric_limits<double>::infinity()" : "std::numeric_limits<double>::infinity()";
+    }
+
+    std::ostringstream out;
+    out << std::setprecision(17) << number;
+    std::string text = out.str();
+    if (text.find_first_of(".eE") == std::string::npos) text += ".0";
+    return text;
+}
+
+// PropertyAttributes flags as an expression, e.g.
+// "PropertyAttributes::Replicated | PropertyAttributes::Persistent"
+std::string attributes_expression(const uint32_t attributes)
+{
+    constexpr std::pair<uint32_t, const char *> flags[] = {
+        {PropertyAttributes::Replicated, "PropertyAttributes::Replicated"},
+        {PropertyAttributes::Persistent, "PropertyAttributes::Persistent"},
+        {PropertyAttributes::EditorOnly, "PropertyAttributes::EditorOnly"},
+        {PropertyAttributes::Transient, "PropertyAttributes::Transient"}};
+
+    std::string text;
+    for (const auto &[flag, name] : flags)
+    {
+        if (!(attributes & flag)) continue;
+        if (!text.empty()) text += " | ";
+        text += name;
+    }
+    return text.empty() ? "PropertyAttributes::None" : text;
+}
+
+// AttributeArguments aggregate initializer, in member order
+std::string arguments_initializer(const AttributeArguments &arguments)
+{
+    return "{" + std::to_string(arguments.history_depth) + ", " + (arguments.has_range ? "true" : "false") + ", " +
+           double_literal(arguments.range_min) + ", " + double_literal(arguments.range_max) + "}";
+}
+
+// member initializer for the declared default; mismatched defaults fall back
+// to the value a store would use for that column
+std::string default_initializer(const PropertyDescriptor &prop, const ValueKind kind)
+{
+    const auto &value = prop.default_value;
+    switch (kind)
+    {
+    case ValueKind::Int:
+        return std::to_string(std::holds_alternative<int>(value) ? std::get<int>(value) : 0);
+    case ValueKind::Double:
+        return std::holds_alternative<double>(value) ? double_literal(std::get<double>(value)) : "0.0";
+    case ValueKind::String:
+        return std::holds_alternative<std::string>(value) ? string_literal(std::get<std::string>(value)) : "\"\"";
+    case ValueKind::Bool:
+        return std::holds_alternative<bool>(value) && std::get<bool>(value) ? "true" : "false";
+    case ValueKind::Ref:
+        return "";
+    }
+
+    return "";
+}
+
+// bases before derived types; fails on missing bases and cycles
+bool order_types(const std::vector<const TypeDescriptor *> &types, std::vector<const TypeDescriptor *> &ordered)
+{
+    std::unordered_map<std::string, const TypeDescriptor *> by_name;
+    for (const auto *type : types)
+    {
+        by_name[type->type_name] = type;
+    }
+
+    std::set<std::string> emitted;
+    std::set<std::string> visiting;
+    std::function<bool(const TypeDescriptor *)> visit = [&](const TypeDescriptor *type) -> bool
+    {
+        if (emitted.count(type->type_name)) return true;
+        if (!visiting.insert(type->type_name).second)
+        {
+            report_error("inheritance cycle through '" + type->type_name + "'");
+            return false;
+        }
+
+        if (!type->base_type_name.empty())
+        {
+            const auto base = by_name.find(type->base_type_name);
+            if (base == by_name.end())
+            {
+                report_error("base type '" + type->base_type_name + "' of '" + type->type_name +
+                             "' is not in the input set");
+                return false;
+            }
+            if (!visit(base->second)) return false;
+        }
+
+        emitted.insert(type->type_name);
+        ordered.push_back(type);
+        return true;
+    };
+
+    for (const auto *type : types)
+    {
+        if (!visit(type)) return false;
+    }
+    return true;
+}
+
+void emit_type(std::ostream &out, const TypeDescriptor &type)
+{
+    const auto &name = type.type_name;
+    const auto &base = type.base_type_name;
+    const auto layout = TypeRegistry::instance().get_all_properties(name);
+    const size_t first_slot = layout.size() - type.properties.size();
+
+    // a type without any slots never touches its parameters
+    const std::string unused = layout.empty() ? "[[maybe_unused]] " : "";
+
+    out << "struct " << name << (base.empty() ? "" : " : " + base) << "\n{\n";
+    for (const auto &prop : type.properties)
+    {
+        const auto kind = value_kind_for(prop);
+        const auto init = default_initializer(prop, kind);
+        out << "    " << cpp_type(kind) << " " << prop.name << (init.empty() ? "{}" : " = " + init) << ";\n";
+    }
+    out << "};\n\n";
+
+    out << "template <>\nstruct StaticTypeInfo<" << name << ">\n{\n";
+    out << "    static constexpr const char *type_name = " << string_literal(name) << ";\n";
+    out << "    static constexpr const char *base_type_name = " << string_literal(base) << ";\n";
+    out << "    static constexpr uint32_t attributes = " << attributes_expression(type.attributes) << ";\n";
+    out << "    static constexpr AttributeArguments arguments = " << arguments_initializer(type.arguments) << ";\n";
+    out << "    static constexpr size_t slot_count = " << layout.size() << ";\n";
+    out << "    static constexpr std::array<StaticPropertyInfo, " << type.properties.size() << "> properties = {{\n";
+    for (const auto &prop : type.properties)
+    {
+        out << "        {" << string_literal(prop.name) << ", " << string_literal(prop.type_name) << ", "
+            << kind_name(value_kind_for(prop)) << ", " << attributes_expression(prop.attributes) << ", "
+            << arguments_initializer(prop.arguments) << "},\n";
+    }
+    out << "    }};\n\n";
+
+    out << "    static PropertyValue get(" << unused << "const " << name << " &object, const size_t slot)\n    {\n";
+    if (!base.empty())
+    {
+        out << "        if (slot < " << first_slot << ") return StaticTypeInfo<" << base << ">::get(object, slot);\n\n";
+    }
+    out << "        switch (slot)\n        {\n";
+    for (size_t i = 0; i < type.properties.size(); ++i)
+    {
+        out << "        case " << first_slot + i << ":\n            return object." << type.properties[i].name << ";\n";
+    }
+    out << "        default:\n            return PropertyValue();\n        }\n    }\n\n";
+
+    out << "    static bool set(" << unused << name << " &object, const size_t slot, " << unused
+        << "const PropertyValue &value)\n    {\n";
+    if (!base.empty())
+    {
+        out << "        if (slot < " << first_slot << ") return StaticTypeInfo<" << base
+            << ">::set(object, slot, value);\n\n";
+    }
+    out << "        switch (slot)\n        {\n";
+    for (size_t i = 0; i < type.properties.size(); ++i)
+    {
+        const auto &prop = type.properties[i];
+        out << "        case " << first_slot + i << ":\n";
+        out << "            if (const auto *v = std::get_if<" << cpp_type(value_kind_for(prop)) << ">(&value))\n";
+        out << "            {\n                object." << prop.name << " = *v;\n                return true;\n";
+        out << "            }\n            return false;\n";
+    }
+    out << "        default:\n            return false;\n        }\n    }\n\n";
+
+    out << "    static void serialize(" << unused << "const " << name << " &object, " << unused
+        << "std::string &out)\n    {\n";
+    if (!base.empty())
+    {
+        out << "        StaticTypeInfo<" << base << ">::serialize(object, out);\n";
+    }
+    for (const auto &prop : type.properties)
+    {
+        out << "        write_binary(out, object." << prop.name << ");\n";
+    }
+    out << "    }\n\n";
+
+    out << "    static bool deserialize(" << unused << name << " &object, " << unused << "const char *&cursor, "
+        << unused << "const char *end)\n    {\n";
+    out << "        return ";
+    std::vector<std::string> steps;
+    if (!base.empty())
+    {
+        steps.push_back("StaticTypeInfo<" + base + ">::deserialize(object, cursor, end)");
+    }
+    for (const auto &prop : type.properties)
+    {
+        steps.push_back("read_binary(cursor, end, object." + prop.name + ")");
+    }
+    if (steps.empty())
+    {
+        out << "true";
+    }
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        out << (i ? " &&\n               " : "") << steps[i];
+    }
+    out << ";\n    }\n};\n\n";
+}
+
+std::string generate_header(const std::vector<const TypeDescriptor *> &ordered, const Options &options)
+{
+    std::ostringstream out;
+    out << "// generated by reflektc from";
+    for (const auto &input : options.inputs)
+    {
+        out << " " << input.substr(input.find_last_of("/\\") + 1);
+    }
+    out << "; do not edit\n\n#pragma once\n\n#include \"reflekt.hpp\"\n\n#include <array>\n#include <limits>\n#include "
+           "<string>\n\n";
+
+    for (const auto *type : ordered)
+    {
+        emit_type(out, *type);
+    }
+
+    // every type is attempted; false if any of them collided with a type
+    // registered before
+    out << "inline bool register_" << identifier_from_path(options.output) << "()\n{\n";
+    out << "    bool registered = true;\n";
+    for (const auto *type : ordered)
+    {
+        out << "    registered = register_static_type<" << type->type_name << ">() && registered;\n";
+    }
+    out << "    return registered;\n}\n";
+    return out.str();
+}
+
+bool parse_arguments(const int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+        {
+            options.output = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            report_error("unknown option '" + arg + "'");
+            return false;
+        }
+        else
+        {
+            options.inputs.push_back(arg);
+        }
+    }
+
+    if (options.output.empty() || options.inputs.empty())
+    {
+        std::cerr << "usage: reflektc -o <header> <file.rk>...\n";
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(const int argc, char **argv)
+{
+    Options options;
+    if (!parse_arguments(argc, argv, options)) return 1;
+
+    std::vector<const TypeDescriptor *> types;
+    for (const auto &input : options.inputs)
+    {
+        const auto content = read_file(input);
+        if (!content)
+        {
+            report_error("cannot read '" + input + "'");
+            return 1;
+        }
+
+        std::unique_ptr<TypeDescriptor> type;
+        try
+        {
+            type = PropertyFileParser::parse_simple_format(*content);
+        }
+        catch (const std::exception &e)
+        {
+            report_error(input + ": bad default value (" + e.what() + ")");
+            return 1;
+        }
+        if (!type)
+        {
+            report_error(input + ": no type declaration");
+            return 1;
+        }
+
+        if (!is_identifier(type->type_name) || TypeRegistry::instance().get_type(type->type_name))
+        {
+            report_error(input + ": type name '" + type->type_name +
+                         "' is not a unique, unreserved C++ identifier");
+            return 1;
+        }
+        for (const auto &prop : type->properties)
+        {
+            if (!is_identifier(prop.name))
+            {
+                report_error(input + ": property name '" + prop.name + "' is not an unreserved C++ identifier");
+                return 1;
+            }
+            if (!is_known_type(prop.type_name))
+            {
+                report_error(input + ": property '" + prop.name + "' has unknown type '" + prop.type_name + "'");
+                return 1;
+            }
+        }
+
+        const auto name = type->type_name;
+        if (!TypeRegistry::instance().register_type(std::move(type)))
+        {
+            report_error(input + ": '" + name + "' or one of its properties collides with another name's hash");
+            return 1;
+        }
+        types.push_back(TypeRegistry::instance().get_type(name));
+    }
+
+    std::vector<const TypeDescriptor *> ordered;
+    if (!order_types(types, ordered)) return 1;
+
+    // a property redeclared in a derived type would only shadow the base member
+    for (const auto *type : ordered)
+    {
+        std::set<std::string> names;
+        for (const auto &prop : TypeRegistry::instance().get_all_properties(type->type_name))
+        {
+            if (!names.insert(prop.name).second)
+            {
+                report_error("property '" + prop.name + "' of '" + type->type_name + "' is declared twice");
+                return 1;
+            }
+        }
+    }
+
+    std::ofstream out(options.output, std::ios::binary | std::ios::trunc);
+    if (!out || !(out << generate_header(ordered, options)))
+    {
+        report_error("cannot write '" + options.output + "'");
+        return 1;
+    }
+
+    return 0;
+}